@@ -0,0 +1,76 @@
+#include "CompactEncoder.h"
+
+// max bytes taken by a 32 bit varint
+#define VARINT_MAX_BYTES 5
+
+const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+CompactEncoder::CompactEncoder() {
+    reset();
+}
+
+void CompactEncoder::reset() {
+    _length = 0;
+    _previous = 0;
+    _overflowed = false;
+}
+
+bool CompactEncoder::addUnsigned(uint32_t value) {
+    if (_length + VARINT_MAX_BYTES > COMPACT_ENCODER_BUFFER_SIZE) {
+        _overflowed = true;
+        return false;
+    }
+
+    while (value >= 0x80) {
+        _buffer[_length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    _buffer[_length++] = (uint8_t)value;
+    return true;
+}
+
+bool CompactEncoder::addSigned(int32_t value) {
+    return addUnsigned(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+bool CompactEncoder::addDelta(int32_t value) {
+    if (!addSigned((int32_t)((uint32_t)value - (uint32_t)_previous))) {
+        return false;
+    }
+    _previous = value;
+    return true;
+}
+
+void CompactEncoder::truncate(uint16_t length) {
+    if (length < _length) {
+        _length = length;
+    }
+}
+
+uint16_t CompactEncoder::getLength() {
+    return _length;
+}
+
+bool CompactEncoder::hasOverflowed() {
+    return _overflowed;
+}
+
+String CompactEncoder::toBase64() {
+    char output[(COMPACT_ENCODER_BUFFER_SIZE + 2) / 3 * 4 + 1];
+    uint16_t outputLength = 0;
+
+    for (uint16_t i = 0; i < _length; i += 3) {
+        uint32_t block = (uint32_t)_buffer[i] << 16;
+        if (i + 1 < _length) block |= (uint32_t)_buffer[i + 1] << 8;
+        if (i + 2 < _length) block |= _buffer[i + 2];
+
+        // 3 bytes -> 4 chars, fewer chars for a partial final block
+        uint8_t numChars = min(_length - i, 3) + 1;
+        for (uint8_t j = 0; j < numChars; j++) {
+            output[outputLength++] = BASE64_ALPHABET[(block >> (18 - 6 * j)) & 0x3F];
+        }
+    }
+
+    output[outputLength] = '\0';
+    return String(output);
+}
@@ -0,0 +1,76 @@
+#ifndef _COMPACT_ENCODER_H_
+#define _COMPACT_ENCODER_H_
+
+#include "Particle.h"
+
+// Maximum number of encoded bytes (base64 output is 4/3 of this)
+#define COMPACT_ENCODER_BUFFER_SIZE 192
+
+/**
+ * @brief Packs integer arrays into a short base64 string for logging
+ *
+ * Values are written as LEB128 varints (7 bits per byte, high bit set on all but the last byte).
+ * Signed values are zig-zag encoded so small negative numbers stay small ( 0, -1, 1, -2 -> 0, 1, 2, 3 ),
+ * and addDelta() writes the difference from the previous delta value, so slowly varying arrays
+ * (cell voltages, coordinates) cost ~1 byte per element.
+ *
+ * @note decoding: base64 decode, read varints, undo zig-zag ( (n >> 1) ^ -(n & 1) ) then prefix sum the deltas
+ */
+class CompactEncoder {
+    public:
+        CompactEncoder();
+
+        /**
+         * @brief Clears encoded data and previous delta value
+         */
+        void reset();
+
+        /**
+         * @brief Appends unsigned value as a varint
+         *
+         * @return false if buffer is full (value is not added)
+         */
+        bool addUnsigned(uint32_t value);
+
+        /**
+         * @brief Appends signed value as a zig-zag varint
+         *
+         * @return false if buffer is full (value is not added)
+         */
+        bool addSigned(int32_t value);
+
+        /**
+         * @brief Appends difference between value and the previous value passed to addDelta (0 after reset)
+         *
+         * @return false if buffer is full (value is not added)
+         */
+        bool addDelta(int32_t value);
+
+        /**
+         * @brief Discards bytes after length (ie. to drop a partially added group of values)
+         */
+        void truncate(uint16_t length);
+
+        /**
+         * @brief Number of encoded bytes
+         */
+        uint16_t getLength();
+
+        /**
+         * @brief true if a value could not be added because the buffer was full
+         */
+        bool hasOverflowed();
+
+        /**
+         * @brief Encoded bytes as a base64 string (RFC 4648 alphabet, no padding)
+         */
+        String toBase64();
+
+    private:
+        uint8_t _buffer[COMPACT_ENCODER_BUFFER_SIZE];
+        uint16_t _length;
+        int32_t _previous;
+        bool _overflowed;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "DataQueue.h"
+#include "TimeBase.h"
 
 DataQueue::DataQueue(String vehicleName,  void (*callback)(String, PublishData)) {
 	_vehicleName = vehicleName;
@@ -20,8 +21,18 @@ void DataQueue::handle() {
 }
 
 JsonObject DataQueue:: createDataObject() {
+	bool valid;
+	uint64_t now = TimeBase::instance().nowMillis(valid);
+
+	// batch base time is the first record's second, records store their offset from it
+	if (!_hasBaseTime) {
+		_baseTime = now / 1000;
+		_jsonDocument["b"] = _baseTime;
+		_hasBaseTime = true;
+	}
+
 	JsonObject object = _jsonDocument["l"].as<JsonArray>().createNestedObject();
-	object["t"] = Time.now();
+	object["t"] = (int32_t)(now - (uint64_t)_baseTime * 1000);
 	return object.createNestedObject("d");
 }
 
@@ -82,6 +93,11 @@ String DataQueue::_jsonBufferGet() {
 void DataQueue::_jsonDocumentInit() {
     _jsonDocument["v"] = _vehicleName;
 	_jsonDocument.createNestedArray("l");
+	_hasBaseTime = false;
+}
+
+bool DataQueue::hasBaseTime() {
+	return _hasBaseTime;
 }
 
 size_t DataQueue::getNumEventsInQueue() {
@@ -21,7 +21,9 @@
  * @brief DataQueue which provides API for logging and publishing of data to Particle cloud
  * 
  * @note SYSTEM_THREAD(ENABLED) must be called in on startup, or this object may fail in unpredictable ways
- * @note formatting is specified in the methods _jsonDocumentInit and createDataObject.
+ * @note formatting is specified in the methods _jsonDocumentInit and createDataObject:
+ * {"v":vehicle,"l":[{"t":ms after b,"d":{data}},...],"b":unix time (s) of first record}
+ * record times come from TimeBase (millisecond resolution once disciplined by gps)
  * If you wish to change the formatting, you must also modify (or remove) _recoverDataFromBuffer
  **/
 
@@ -112,6 +114,11 @@ class DataQueue : public Handleable {
          **/
         bool isCacheFull();
 
+        /**
+         * @brief Returns true once the current batch has a base time, ie. its first data object has been created
+         */
+        bool hasBaseTime();
+
         /**
          * @brief Returns false if StaticJsonDocument has overflowed
          */
@@ -123,7 +130,8 @@ class DataQueue : public Handleable {
         void (*_publishCallback)(String, PublishData);
         unsigned long _lastPublish;
         String _vehicleName;
-        
+        uint32_t _baseTime;
+        bool _hasBaseTime = false;
 
         /**
          * Removes the data stored in the StaticJsonDocument member and clears its currently held data
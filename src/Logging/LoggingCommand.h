@@ -50,4 +50,53 @@ class LoggingCommand : public IntervalCommand {
         String _propertyName;
 };
 
-#endif
\ No newline at end of file
+/**
+ *  Templated Command class which logs one entry of a table-described object (ie. one field of a frame)
+ *  class C is the type of object whose indexed getter method will be called on execute
+ *  class R is the return type of getter
+ **/
+template <class C, class R>
+class IndexedLoggingCommand : public IntervalCommand {
+    public:
+        /**
+         * Constructs an IndexedLoggingCommand with object, property name, indexed getter method pointer, index and interval.
+         * Adds this to static collection of interval commands
+         * 
+         * @param object pointer to object of class C which we will call _getter on
+         * @param propertyName the name of property which will be logged
+         * @param getter pointer to object's getter method, called with index
+         * @param index index passed to getter
+         * @param interval interval (in seconds) at which this command will be called to execute
+         **/
+        IndexedLoggingCommand(C* object, String propertyName, R (C::*getter)(uint8_t, bool&), uint8_t index, uint16_t interval)
+        : IntervalCommand(interval) {
+            _object = object;
+            _getter = getter;
+            _index = index;
+            _propertyName = propertyName;
+            IntervalCommandHandler::instance().add(this);
+        }
+
+        ~IndexedLoggingCommand() { }
+
+        /**
+         * @brief Logs data from this command's getter method to JsonObject
+         * 
+         * @param args pointer to JsonObject
+         */
+        void execute(CommandArgs args) override {
+            bool valid;
+            R value = (*_object.*_getter)(_index, valid);
+            if (valid) {
+                (*(JsonObject*)args)[_propertyName] = value;
+            }
+        }
+
+    private:
+        R (C::*_getter)(uint8_t, bool&);
+        C *_object;
+        uint8_t _index;
+        String _propertyName;
+};
+
+#endif
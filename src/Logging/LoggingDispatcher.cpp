@@ -1,6 +1,9 @@
 #include "LoggingDispatcher.h"
 
-#define DATAOBJECT_AND_TIMESTAMP_SIZE 23
+// {"t":123456,"d":{}}, offset from batch base time in ms
+#define DATAOBJECT_AND_TIMESTAMP_SIZE 19
+// "b":1642311306, on the first data object of a batch
+#define BATCH_BASE_TIME_SIZE 15
 
 LoggingDispatcher::LoggingDispatcher(IntervalCommandGroup** commandGroups, uint16_t numCommandGroups, DataQueue* dataQ, String publishName) {
     _commandGroups = commandGroups;
@@ -51,8 +54,11 @@ void LoggingDispatcher::_runLogging() {
         bool createNewDataObject = true;
         JsonObject dataObject;
         for (uint16_t i = 0; i < _numCommandGroups; i++) {
-            // NOTE: creating new JsonObject -> {"t":1642311306,"d":{}} = 23 Bytes
-            unsigned additionalBytes = createNewDataObject ? DATAOBJECT_AND_TIMESTAMP_SIZE : 0;
+            // NOTE: creating new JsonObject -> {"t":123456,"d":{}} = 19 Bytes (+ "b":1642311306, = 15 Bytes for first object in batch)
+            unsigned additionalBytes = 0;
+            if (createNewDataObject) {
+                additionalBytes = DATAOBJECT_AND_TIMESTAMP_SIZE + (_dataQ->hasBaseTime() ? 0 : BATCH_BASE_TIME_SIZE);
+            }
             if (_commandGroups[i]->getExecuteThisLoop() && _dataQ->getDataSize() + _maxPublishSizes[i] + additionalBytes >= _dataQ->getBufferSize()) {
                 _publish();
                 createNewDataObject = true;
@@ -0,0 +1,107 @@
+#include "BmsFaultJournal.h"
+#include "settings.h"
+#include "PublishQueuePosixRK.h"
+
+// Identifies an initialized journal (changing Entry layout requires a new value)
+#define JOURNAL_MAGIC           0x464A0001
+// Minimum time between fault publishes (ms), Particle limits publishes to 1 per second
+#define PUBLISH_INTERVAL        1000
+
+BmsFaultJournal::BmsFaultJournal(String eventName) : _eventName(eventName) {
+    _header = { JOURNAL_MAGIC, 0, 0, 0, 0 };
+}
+
+void BmsFaultJournal::begin() {
+    EEPROM.get(FAULT_JOURNAL_EEPROM_ADDRESS, _header);
+
+    if (_header.magic != JOURNAL_MAGIC || _header.head >= FAULT_JOURNAL_SIZE ||
+        _header.count > FAULT_JOURNAL_SIZE || _header.unpublished > _header.count) {
+        _header = { JOURNAL_MAGIC, 0, 0, 0, 0 };
+        EEPROM.put(FAULT_JOURNAL_EEPROM_ADDRESS, _header);
+    }
+}
+
+void BmsFaultJournal::handle() {
+    // result of a direct publish is checked without waiting for the cloud
+    if (_publishPending) {
+        if (!_publishResult.isDone()) {
+            return;
+        }
+        _publishPending = false;
+        if (_publishResult.isSucceeded() && _publishResult.result()) {
+            _markPublished();
+        }
+        // failed publishes are retried (or queued if now offline) after PUBLISH_INTERVAL
+    }
+
+    if (_header.unpublished == 0 || millis() - _lastPublish < PUBLISH_INTERVAL) {
+        return;
+    }
+
+    // oldest unpublished entry
+    Entry entry;
+    uint16_t index = (_header.head + FAULT_JOURNAL_SIZE - _header.unpublished) % FAULT_JOURNAL_SIZE;
+    EEPROM.get(_address(index), entry);
+
+    char payload[160];
+    snprintf(payload, sizeof(payload),
+        "{\"t\":%lu,\"up\":%lu,\"f\":%u,\"on\":%u,\"v\":%.1f,\"a\":%.1f,\"tmax\":%d,\"tmin\":%d,\"tbms\":%d}",
+        (unsigned long)entry.time, (unsigned long)entry.uptime, entry.code, entry.onset,
+        entry.voltage / 10.0, entry.current / 10.0, entry.tempMax, entry.tempMin, entry.tempBms);
+
+    _lastPublish = millis();
+    if (Particle.connected()) {
+        // published directly so faults don't wait behind telemetry batches backlogged in PublishQueuePosix
+        _publishResult = Particle.publish(_eventName, payload, PRIVATE, WITH_ACK);
+        _publishPending = true;
+    } else if (PublishQueuePosix::instance().publish(_eventName, String(payload), PRIVATE, WITH_ACK)) {
+        // offline: persisted by PublishQueuePosix until connected
+        _markPublished();
+    }
+}
+
+void BmsFaultJournal::record(CanSensorBms* bms, int previousFault, int fault) {
+    if (previousFault != BmsFault::NONE) {
+        _add(bms, previousFault, false);
+    }
+    if (fault != BmsFault::NONE) {
+        _add(bms, fault, true);
+    }
+}
+
+int BmsFaultJournal::getUnpublishedCount(bool& valid) {
+    valid = true;
+    return _header.unpublished;
+}
+
+void BmsFaultJournal::_markPublished() {
+    _header.unpublished--;
+    EEPROM.put(FAULT_JOURNAL_EEPROM_ADDRESS, _header);
+}
+
+void BmsFaultJournal::_add(CanSensorBms* bms, uint8_t code, bool onset) {
+    Entry entry;
+    entry.time = Time.isValid() ? Time.now() : 0;
+    entry.uptime = millis();
+    entry.code = code;
+    entry.onset = onset;
+    entry.voltage = (int16_t)(bms->getPackVoltage() * 10.0f);
+    entry.current = (int16_t)(bms->getPackCurrent() * 10.0f);
+    entry.tempMax = bms->getMaxBatteryTemp();
+    entry.tempMin = bms->getMinBatteryTemp();
+    entry.tempBms = bms->getTempBms();
+    entry.reserved = 0;
+
+    EEPROM.put(_address(_header.head), entry);
+
+    _header.head = (_header.head + 1) % FAULT_JOURNAL_SIZE;
+    _header.count = min(_header.count + 1, FAULT_JOURNAL_SIZE);
+    _header.unpublished = min(_header.unpublished + 1, FAULT_JOURNAL_SIZE);
+    EEPROM.put(FAULT_JOURNAL_EEPROM_ADDRESS, _header);
+
+    DEBUG_SERIAL_LN("BMS Fault " + String(onset ? "Onset: " : "Cleared: ") + BmsFault::toString(code));
+}
+
+int BmsFaultJournal::_address(uint16_t index) {
+    return FAULT_JOURNAL_EEPROM_ADDRESS + sizeof(Header) + index * sizeof(Entry);
+}
@@ -0,0 +1,99 @@
+#ifndef _BMS_FAULT_JOURNAL_H_
+#define _BMS_FAULT_JOURNAL_H_
+
+#include "CanSensorBms.h"
+
+// Number of entries kept in the EEPROM ring (oldest entries are overwritten)
+#define FAULT_JOURNAL_SIZE 32
+// EEPROM address of journal header, entries are stored directly after it
+#define FAULT_JOURNAL_EEPROM_ADDRESS 0
+
+/**
+ * @brief Records bms fault onsets and clears with a snapshot of the pack, persisted in an EEPROM ring
+ * and published as a separate event, directly while connected (ahead of queued telemetry) or through
+ * PublishQueuePosix while offline
+ *
+ * @note feed with record() from the bms fault callback (see CanSensorBms::setFaultCallback)
+ */
+class BmsFaultJournal : public Handleable {
+    public:
+        /**
+         * @brief Journal entry as stored in EEPROM
+         */
+        struct Entry {
+            uint32_t time;          // unix time (s), 0 if time was not valid
+            uint32_t uptime;        // millis() at time of fault
+            uint8_t code;           // BmsFault::Code
+            uint8_t onset;          // 1 when fault started, 0 when it cleared
+            int16_t voltage;        // pack voltage (0.1 V)
+            int16_t current;        // pack current (0.1 A)
+            int8_t tempMax;         // max battery temperature (C)
+            int8_t tempMin;         // min battery temperature (C)
+            int8_t tempBms;         // bms temperature (C)
+            uint8_t reserved;
+        };
+
+        /**
+         * Constructor
+         *
+         * @param eventName name of the event entries are published to
+         */
+        BmsFaultJournal(String eventName);
+
+        /**
+         * @brief Restores journal from EEPROM (or initializes it if it is empty/corrupt)
+         */
+        void begin() override;
+
+        /**
+         * @brief Publishes oldest unpublished entry (at most once per second) without blocking: directly while
+         * connected, checking the result on later calls, otherwise through the publish queue
+         */
+        void handle() override;
+
+        /**
+         * @brief Records fault clear of previous fault and onset of new fault
+         *
+         * @param bms bms whose fault changed (used for snapshot)
+         * @param previousFault fault code before change
+         * @param fault fault code after change
+         */
+        void record(CanSensorBms* bms, int previousFault, int fault);
+
+        /**
+         * @brief Number of entries which have not been published (or queued while offline) yet
+         */
+        int getUnpublishedCount(bool& valid);
+
+    private:
+        struct Header {
+            uint32_t magic;
+            uint16_t head;          // index of next entry to write
+            uint16_t count;         // number of entries in ring
+            uint16_t unpublished;   // number of newest entries not yet published
+            uint16_t reserved;
+        };
+
+        String _eventName;
+        Header _header;
+        unsigned long _lastPublish = 0;
+        particle::Future<bool> _publishResult;
+        bool _publishPending = false;
+
+        /**
+         * @brief Oldest unpublished entry has been published (or queued), writes header to EEPROM
+         */
+        void _markPublished();
+
+        /**
+         * @brief Adds entry to ring and writes it (and header) to EEPROM
+         */
+        void _add(CanSensorBms* bms, uint8_t code, bool onset);
+
+        /**
+         * @brief EEPROM address of entry at ring index
+         */
+        int _address(uint16_t index);
+};
+
+#endif
@@ -2,6 +2,8 @@
 
 #define UPDATE_INTERVAL 1000
 #define MILLISECONDS_BEFORE_DESELECT 10000
+// Number of intervals in which only the inactive bms received frames before switching to it
+#define SWITCH_CONFIRMATIONS 2
 
 BmsManager::BmsManager(CanSensorBms** bmsPtr, CanSensorBms* orion, CanSensorBms* tiny, BmsOption option) : _mainBmsPtr(bmsPtr), _orion(orion), _tiny(tiny), _currentOption(option) {
 	setBms(option);
@@ -13,16 +15,27 @@ void BmsManager::begin() { }
 
 void BmsManager::handle() {
 	if (millis() > _lastTime + UPDATE_INTERVAL) {
-		BmsOption newOption = None;
-		
-		if (_orion->getLastUpdateTime() > _tiny->getLastUpdateTime()) {
-			newOption = Orion;
-		} else if (_orion->getLastUpdateTime() < _tiny->getLastUpdateTime()) {
-			newOption = Tiny;
+		uint32_t orionFrames = _orion->getFrameCount();
+		uint32_t tinyFrames = _tiny->getFrameCount();
+		uint32_t orionRate = orionFrames - _lastOrionFrames;
+		uint32_t tinyRate = tinyFrames - _lastTinyFrames;
+		_lastOrionFrames = orionFrames;
+		_lastTinyFrames = tinyFrames;
+
+		uint32_t currentRate = _currentOption == Orion ? orionRate : tinyRate;
+		uint32_t otherRate = _currentOption == Orion ? tinyRate : orionRate;
+
+		// hysteresis: any traffic from active bms resets confirmations, intervals with no traffic at all leave them unchanged
+		// (a sleeping TinyBMS is only probed every 2 s)
+		if (currentRate > 0) {
+			_switchConfirmations = 0;
+		} else if (otherRate > 0) {
+			_switchConfirmations++;
 		}
-		
-		if (newOption != None && _currentOption != newOption) {
-			setBms(newOption);
+
+		if (_switchConfirmations >= SWITCH_CONFIRMATIONS) {
+			setBms(_currentOption == Orion ? Tiny : Orion);
+			_switchConfirmations = 0;
 		}
 
 		_lastTime = millis();
@@ -25,7 +25,8 @@ class BmsManager : public Handleable {
         void begin() override;
 
         /**
-         * Redirects primary bms pointer to whichever has most recently received messages
+         * Redirects primary bms pointer to the other bms once the active bms has received no frames while the other has,
+         * over SWITCH_CONFIRMATIONS intervals (frames are counted even while a bms is asleep, see CanListener::getFrameCount)
          * */
         void handle() override;
 
@@ -55,6 +56,9 @@ class BmsManager : public Handleable {
 		CanSensorBms* _tiny;
 		BmsOption _currentOption = None;
 		uint64_t _lastTime = 0;
+		uint32_t _lastOrionFrames = 0;
+		uint32_t _lastTinyFrames = 0;
+		uint8_t _switchConfirmations = 0;
 };
 
 #endif
\ No newline at end of file
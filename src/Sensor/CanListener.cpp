@@ -2,10 +2,36 @@
 
 CanListener::CanListener(CanInterface &canInterface) : _canInterface(canInterface) { }
 
-CanListener::CanListener(CanInterface &canInterface, uint16_t id) : _canInterface(canInterface), _id(id) { }
+CanListener::CanListener(CanInterface &canInterface, uint32_t id, bool extended) : _canInterface(canInterface), _id(id), _extended(extended) { }
 
 void CanListener::begin() {
-	_canInterface.addMessageListen(_id, new CanListener::CanListenerDelegate(this));
+	_addListen(_id, new CanListener::CanListenerDelegate(this), _extended);
+}
+
+void CanListener::setListening(bool enabled) {
+	_listening = enabled;
+	for (uint8_t i = 0; i < _numListenIds; i++) {
+		_canInterface.setListenEnabled(_listenIds[i], enabled, _listenExtended[i]);
+	}
+}
+
+uint32_t CanListener::getFrameCount() {
+	uint32_t count = 0;
+	for (uint8_t i = 0; i < _numListenIds; i++) {
+		count += _canInterface.getFrameCount(_listenIds[i], _listenExtended[i]);
+	}
+	return count;
+}
+
+void CanListener::_addListen(uint32_t id, Command* delegate, bool extended) {
+	_canInterface.addMessageListen(id, delegate, extended);
+	_canInterface.setListenEnabled(id, _listening, extended);
+
+	if (_numListenIds < CAN_LISTENER_MAX_IDS) {
+		_listenIds[_numListenIds] = id;
+		_listenExtended[_numListenIds] = extended;
+		_numListenIds++;
+	}
 }
 
 void CanListener::CanListenerDelegate::execute(CommandArgs args) {
@@ -5,12 +5,15 @@
 #include "CanInterface.h"
 #include "can_common.h"
 
+// Maximum number of ids one CanListener can listen for
+#define CAN_LISTENER_MAX_IDS 8
+
 /**
  * @brief Base CanListener class for specifying parsing behavior of can messages with id.
  * update is called every time CanInterface receives a message with id
  * 
  * @note if for whatever reason you want to recieve can messages of multiple different ids, you will
- * need to override begin() in derived class and invoke CanInterface.addMessageListen multiple times
+ * need to override begin() in derived class and invoke _addListen multiple times
  * 
  */
 class CanListener : public Sensor {
@@ -29,10 +32,11 @@ class CanListener : public Sensor {
          * 
          * @param canInterface can interface object
          * @param id the can id that this class will listen for
+         * @param extended true if id is a 29-bit extended identifier
 		 * 
 		 * @note only use this constructor if you are listening for a single id
          **/
-        CanListener(CanInterface &canInterface, uint16_t id);
+        CanListener(CanInterface &canInterface, uint32_t id, bool extended = false);
 
         /**
 		 * @brief Default implementation: adds single id and delegate to can interface
@@ -45,9 +49,31 @@ class CanListener : public Sensor {
 
         virtual String getHumanName() = 0;
 
+        /**
+         * @brief Enables or disables dispatch of every id this listener listens for (see CanInterface::setListenEnabled)
+         * 
+         * @note may be called before begin(): ids are added in this state
+         */
+        void setListening(bool enabled);
+
+        /**
+         * @brief Total number of frames received with any of this listener's ids, including frames not dispatched
+         */
+        uint32_t getFrameCount();
+
     protected:
         CanInterface &_canInterface;
-        uint16_t _id;
+        uint32_t _id;
+        bool _extended = false;
+
+        /**
+         * @brief Adds id and delegate to can interface and records id for setListening and getFrameCount
+         * 
+         * @param id to listen for on CAN bus
+         * @param delegate delegate command passing messages to update
+         * @param extended true if id is a 29-bit extended identifier
+         */
+        void _addListen(uint32_t id, Command* delegate, bool extended = false);
 
         /**
 		 * CanListener-internal class which acts as a delegate to CanInterface; allows
@@ -71,6 +97,11 @@ class CanListener : public Sensor {
 		};
 
     private:
+        uint32_t _listenIds[CAN_LISTENER_MAX_IDS];
+        bool _listenExtended[CAN_LISTENER_MAX_IDS];
+        uint8_t _numListenIds = 0;
+        bool _listening = true;
+
         /**
          * @brief Specifies CanMessage updating behavior -- invoked by delegate in CanInterface
          * 
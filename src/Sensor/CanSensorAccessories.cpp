@@ -18,7 +18,7 @@ const uint8_t STATUS_IDS[] {
 	ACC_STATUS_WIPERS
 };
 
-CanSensorAccessories::CanSensorAccessories(CanInterface &canInterface, uint16_t id)
+CanSensorAccessories::CanSensorAccessories(CanInterface &canInterface, uint32_t id)
 	: CanListener(canInterface, id) {
 	
 	for (uint8_t id : STATUS_IDS)
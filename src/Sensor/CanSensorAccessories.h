@@ -30,7 +30,7 @@ class CanSensorAccessories : public CanListener {
 		 * @param ids the individual ids of the Can accessories whose status we want (0xFF == unused)
 		 * @note size of ids array can be increased if we need to listen for more Can status messages
 		 */
-		CanSensorAccessories(CanInterface &canInterface, uint16_t id);
+		CanSensorAccessories(CanInterface &canInterface, uint32_t id);
 
 		/**
 		 * @brief Nothing to handle here
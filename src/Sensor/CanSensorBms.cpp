@@ -2,7 +2,7 @@
 
 CanSensorBms::CanSensorBms(CanInterface& canInterface) : CanListener(canInterface) { }
 
-CanSensorBms::CanSensorBms(CanInterface& canInterface, uint16_t id) : CanListener(canInterface, id) { }
+CanSensorBms::CanSensorBms(CanInterface& canInterface, uint32_t id) : CanListener(canInterface, id) { }
 
 CanSensorBms::~CanSensorBms() { }
 
@@ -23,10 +23,81 @@ uint64_t CanSensorBms::getLastUpdateTime() {
 
 void CanSensorBms::setIsAsleep(bool value) {
 	_isAsleep = value;
+	setListening(!value);
 }
 
-bool CanSensorBms::_validate(uint16_t id) {
-    return (millis() - _validationMap[id]) < STALE_INTERVAL;
+void CanSensorBms::setPowerCallback(void (*power)(float, float)) {
+	_powerCallback = power;
+}
+
+void CanSensorBms::setFaultCallback(void (*fault)(CanSensorBms*, int, int)) {
+	_faultCallback = fault;
+}
+
+float CanSensorBms::getPackVoltage() {
+	return _batteryVoltage;
+}
+
+float CanSensorBms::getPackCurrent() {
+	return _batteryCurrent;
+}
+
+String CanSensorBms::getCellVoltages(bool& valid) {
+	valid = _validate(CellTable, CELL_STALE_INTERVAL);
+
+	CompactEncoder encoder;
+	for (uint8_t i = 0; i < _numCells; i++) {
+		encoder.addDelta(_cellVoltages[i]);
+	}
+	return encoder.toBase64();
+}
+
+float CanSensorBms::getCellVoltage(uint8_t index) {
+	return index < _numCells ? _cellVoltages[index] / 1000.0f : 0.0f;
+}
+
+uint8_t CanSensorBms::getNumCells() {
+	return _numCells;
+}
+
+void CanSensorBms::_setCellVoltage(uint8_t index, float voltage) {
+	if (index >= BMS_MAX_CELLS) {
+		return;
+	}
+
+	_cellVoltages[index] = (uint16_t)(voltage * 1000.0f + 0.5f);
+	_numCells = max(_numCells, (uint8_t)(index + 1));
+	_cellsRead |= (1UL << index);
+
+	uint32_t allCells = _numCells == 32 ? 0xFFFFFFFF : (1UL << _numCells) - 1;
+	if ((_cellsRead & allCells) == allCells) {
+		_setValid(CellTable);
+		_cellsRead = 0;
+	}
+}
+
+bool CanSensorBms::_validate(ValidityId id, uint32_t staleInterval) {
+    return _validity.isValid(id, millis(), staleInterval);
+}
+
+void CanSensorBms::_setValid(ValidityId id) {
+	_validity.set(id, millis());
+}
+
+void CanSensorBms::_notifyPower() {
+	if (_powerCallback && !_isAsleep && _validate(BatteryVoltage)) {
+		_powerCallback(_batteryVoltage, _batteryCurrent);
+	}
+}
+
+void CanSensorBms::_checkFault() {
+	int fault = getFault();
+	if (fault != _lastFault) {
+		if (_faultCallback && !_isAsleep) {
+			_faultCallback(this, _lastFault, fault);
+		}
+		_lastFault = fault;
+	}
 }
 
 void CanSensorBms::_sendSocUpdate() {
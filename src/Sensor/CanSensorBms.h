@@ -4,9 +4,16 @@
 #include "CanListener.h"
 #include "CanInterface.h"
 #include "BmsFault.h"
+#include "CompactEncoder.h"
+#include "ValidityTable.h"
 
 #define SOC_UPDATE_INTERVAL 497 // slighty off to avoid overlapping with other can write intervals
 
+// Size of per-cell voltage table (cells with a higher index are ignored)
+#define BMS_MAX_CELLS 32
+// Cells are read over several seconds, so the table is valid for longer than STALE_INTERVAL
+#define CELL_STALE_INTERVAL 10000
+
 using namespace BmsFault;
 
 /**
@@ -18,7 +25,7 @@ class CanSensorBms : public CanListener {
 		// Constructors
 		CanSensorBms(CanInterface& caninterface);
 
-		CanSensorBms(CanInterface& caninterface, uint16_t id);
+		CanSensorBms(CanInterface& caninterface, uint32_t id);
 
 		~CanSensorBms();
 
@@ -34,8 +41,23 @@ class CanSensorBms : public CanListener {
 		 */
 		uint64_t getLastUpdateTime();
 
+		/**
+		 * @brief Set the callback function notified of every battery current update (while awake)
+		 * 
+		 * @param power() Pointer to function to call with battery voltage (V) and current (A, positive when discharging)
+		 */
+		void setPowerCallback(void (*power)(float, float));
+
+		/**
+		 * @brief Set the callback function notified whenever the universal fault code (getFault) changes (while awake)
+		 * 
+		 * @param fault() Pointer to function to call with this bms, previous fault code and new fault code
+		 */
+		void setFaultCallback(void (*fault)(CanSensorBms*, int, int));
+
 		/**
 		 * @brief if true, this bms will stop sending out can messages which compete with other bms instances
+		 * and its messages are no longer dispatched to it (they are still counted, see CanListener::getFrameCount)
 		 */
 		void setIsAsleep(bool value);
 		
@@ -64,6 +86,34 @@ class CanSensorBms : public CanListener {
          */
 		virtual String getAvgVolt(bool& valid = Sensor::dummy) = 0;
 
+		/**
+		 * @brief Get the latest battery voltage (V) without validation
+		 */
+		float getPackVoltage();
+
+		/**
+		 * @brief Get the latest battery current (A) without validation
+		 */
+		float getPackCurrent();
+
+		/**
+		 * @brief Get voltage (mV) of every cell as a compact array: first cell followed by the difference
+		 * between consecutive cells, encoded by CompactEncoder
+		 * 
+		 * @note valid once every cell has been read within CELL_STALE_INTERVAL
+		 */
+		String getCellVoltages(bool& valid = Sensor::dummy);
+
+		/**
+		 * @brief Get voltage (V) of cell at index (0 based)
+		 */
+		float getCellVoltage(uint8_t index);
+
+		/**
+		 * @brief Get the number of cells in the cell voltage table
+		 */
+		uint8_t getNumCells();
+
         /**
          * @brief Get the battery state of charge
          */
@@ -113,6 +163,9 @@ class CanSensorBms : public CanListener {
         enum BmsStatus { Charging, Charged, Discharging, Regeneration, Idle, FaultError, ChargeEnabled, DischargeEnabled, Unknown };
 		const char* BMS_STATUS_STRINGS[9] = { "Charging...", "Charged!", "Discharging...", "Regeneration", "Idle", "Fault Error", "Charge Enabled", "Discharge Enabled", "Unknown" };
 
+		// Values whose last update time is tracked for validation (shared by all bms types)
+		enum ValidityId { BatteryVoltage, BatteryCurrent, CellVoltageMax, CellVoltageMin, Soc, TempBms, TempBattery1, TempBattery2, Status, Events, CellTable, Limits, NUM_VALIDITY_IDS };
+
 		// Data
 		float _batteryVoltage = 0.0f;
         float _batteryCurrent = 0.0f;
@@ -122,20 +175,56 @@ class CanSensorBms : public CanListener {
         int _tempBms = 0;
         int _fault = NONE;
         BmsStatus _bmsStatus = Unknown;
+		uint16_t _cellVoltages[BMS_MAX_CELLS] = { 0 };
+		uint8_t _numCells = 0;
 
 		// Mangagement
 		uint64_t _lastUpdateTime = 0;
 		uint64_t _lastSocUpdate = 0;
 		bool _isAsleep = false;
-		std::map<uint16_t, uint64_t> _validationMap;
+		ValidityTable<NUM_VALIDITY_IDS> _validity;
+		uint32_t _cellsRead = 0;
+		void (*_powerCallback)(float, float) = NULL;
+		void (*_faultCallback)(CanSensorBms*, int, int) = NULL;
+		int _lastFault = NONE;
 
 		/**
 		 * @brief Validate current value based on value id
 		 * 
-		 * @param id numeric id of property to be validated
-		 * @returns true if property is valid
+		 * @param id id of property to be validated
+		 * @param staleInterval time (ms) after last update at which property becomes invalid
+		 * @returns true if property has been updated within staleInterval
+		 */
+        bool _validate(ValidityId id, uint32_t staleInterval = STALE_INTERVAL);
+
+		/**
+		 * @brief Records that property has just been updated
+		 * 
+		 * @param id id of property which was updated
+		 */
+		void _setValid(ValidityId id);
+
+		/**
+		 * @brief Stores a cell voltage: once every cell has been read, the cell table is marked as valid
+		 * 
+		 * @param index cell index (0 based)
+		 * @param voltage cell voltage in V
+		 */
+		void _setCellVoltage(uint8_t index, float voltage);
+
+		/**
+		 * @brief Passes latest battery voltage and current to power callback (if set and this bms is awake)
+		 * 
+		 * @note call whenever battery current is updated
+		 */
+		void _notifyPower();
+
+		/**
+		 * @brief Notifies fault callback on every change of getFault() so faults shorter than the logging interval are seen
+		 * 
+		 * @note call after any update which may change the fault code
 		 */
-        bool _validate(uint16_t id);
+		void _checkFault();
 
 		/**
 		 * @brief sends soc update out over can network on SOC_UPDATE_INTERVAL
@@ -1,26 +1,21 @@
 #include "CanSensorOrionBms.h"
+#include "CanSignals.h"
+#include "settings.h"
 
-const uint16_t VALIDATION_IDS[] {
-	CAN_ORIONBMS_STATUS,
- 	CAN_ORIONBMS_PACK,
-	CAN_ORIONBMS_CELL,
-	CAN_ORIONBMS_TEMP,
-};
+using namespace CanSignals;
 
-CanSensorOrionBms::CanSensorOrionBms(CanInterface& canInterface) : CanSensorBms(canInterface) {
-	for (uint16_t id : VALIDATION_IDS) {
-		_validationMap[id] = 0;
-	}
-}
+CanSensorOrionBms::CanSensorOrionBms(CanInterface& canInterface) : CanSensorBms(canInterface) { }
 
 CanSensorOrionBms::~CanSensorOrionBms() { }
 
 void CanSensorOrionBms::begin() {
 	CanListenerDelegate* orionDelegate = new CanListener::CanListenerDelegate(this);
-	_canInterface.addMessageListen(CAN_ORIONBMS_STATUS, orionDelegate);
-	_canInterface.addMessageListen(CAN_ORIONBMS_PACK, orionDelegate);
-	_canInterface.addMessageListen(CAN_ORIONBMS_CELL, orionDelegate);
-	_canInterface.addMessageListen(CAN_ORIONBMS_TEMP, orionDelegate);
+	_addListen(CAN_ORIONBMS_STATUS, orionDelegate);
+	_addListen(CAN_ORIONBMS_PACK, orionDelegate);
+	_addListen(CAN_ORIONBMS_CELL, orionDelegate);
+	_addListen(CAN_ORIONBMS_TEMP, orionDelegate);
+	_addListen(CAN_ORIONBMS_CELL_BROADCAST, orionDelegate);
+	_addListen(CAN_ORIONBMS_LIMITS, orionDelegate);
 }
 
 String CanSensorOrionBms::getHumanName() {
@@ -28,71 +23,120 @@ String CanSensorOrionBms::getHumanName() {
 }
 
 String CanSensorOrionBms::getBatteryVolt(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_PACK);
+    valid  = _validate(BatteryVoltage);
     return FLOAT_TO_STRING(_batteryVoltage, 1);
 }
 
 String CanSensorOrionBms::getBatteryCurrent(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_PACK);
+    valid  = _validate(BatteryCurrent);
     return FLOAT_TO_STRING(_batteryCurrent, 1);
 }
 
 String CanSensorOrionBms::getMinVolt(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_CELL);
+    valid  = _validate(CellVoltageMin);
     return FLOAT_TO_STRING(_cellVoltageMin, 3);
 }
 
 String CanSensorOrionBms::getMaxVolt(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_CELL);
+    valid  = _validate(CellVoltageMax);
     return FLOAT_TO_STRING(_cellVoltageMax, 3);
 }
 
 String CanSensorOrionBms::getAvgVolt(bool& valid) {
-	valid  = _validate(CAN_ORIONBMS_CELL);
+	valid  = _validate(CellVoltageMin);
     return FLOAT_TO_STRING(_cellVoltageAvg, 3);
 }
 
 String CanSensorOrionBms::getSoc(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_PACK);
+    valid  = _validate(Soc);
     return FLOAT_TO_STRING(_soc, 1); 
 }
 
 int CanSensorOrionBms::getTempBms(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_TEMP);
+    valid  = _validate(TempBms);
     return _tempBms;
 }
 
 int CanSensorOrionBms::getMaxBatteryTemp(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_TEMP);
+    valid  = _validate(TempBattery1);
     return _batteryTempMax;
 }
 
 int CanSensorOrionBms::getMinBatteryTemp(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_TEMP);
+    valid  = _validate(TempBattery1);
     return _batteryTempMin;
 }
 
 int CanSensorOrionBms::getAvgBatteryTemp(bool& valid) {
-	valid = _validate(CAN_ORIONBMS_TEMP);
+	valid = _validate(TempBattery1);
 	return _batteryTempAvg;
 }
 
 
 int CanSensorOrionBms::getFault(bool& valid) {
-	valid = _validate(CAN_ORIONBMS_STATUS);
+	valid = _validate(Events);
 	return _fault;
 }
 
 int CanSensorOrionBms::getStatusBms(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_STATUS);
+    valid  = _validate(Status);
     return _bmsStatus;
 }
 
 String CanSensorOrionBms::getStatusBmsString(bool& valid) {
-    valid  = _validate(CAN_ORIONBMS_STATUS);
+    valid  = _validate(Status);
     return String(BMS_STATUS_STRINGS[_bmsStatus]);
 }
 
+int CanSensorOrionBms::getDischargeLimit(bool& valid) {
+	valid = _validate(Limits);
+	return _dischargeLimit;
+}
+
+int CanSensorOrionBms::getChargeLimit(bool& valid) {
+	valid = _validate(Limits);
+	return _chargeLimit;
+}
+
+String CanSensorOrionBms::getCellResistances(bool& valid) {
+	valid = _validate(CellTable, CELL_STALE_INTERVAL);
+
+	CompactEncoder encoder;
+	for (uint8_t i = 0; i < _numCells; i++) {
+		encoder.addDelta(_cells[i].resistance);
+	}
+	return encoder.toBase64();
+}
+
+String CanSensorOrionBms::getCellOpenVoltages(bool& valid) {
+	valid = _validate(CellTable, CELL_STALE_INTERVAL);
+
+	CompactEncoder encoder;
+	for (uint8_t i = 0; i < _numCells; i++) {
+		encoder.addDelta(_cells[i].openVoltage);
+	}
+	return encoder.toBase64();
+}
+
+String CanSensorOrionBms::getBalancingCells(bool& valid) {
+	valid = _validate(CellTable, CELL_STALE_INTERVAL);
+	return String::format("%lx", (unsigned long)_balancingCells);
+}
+
+int CanSensorOrionBms::getNumBalancingCells(bool& valid) {
+	valid = _validate(CellTable, CELL_STALE_INTERVAL);
+
+	int count = 0;
+	for (uint32_t cells = _balancingCells; cells; cells &= cells - 1) {
+		count++;
+	}
+	return count;
+}
+
+const CanSensorOrionBms::CellData& CanSensorOrionBms::getCellData(uint8_t index) {
+	return _cells[index < BMS_MAX_CELLS ? index : 0];
+}
+
 void CanSensorOrionBms::restart() { }
 
 void CanSensorOrionBms::update(CanMessage message) {
@@ -100,32 +144,60 @@ void CanSensorOrionBms::update(CanMessage message) {
 
 	switch (message.id) {
 		case CAN_ORIONBMS_STATUS:
-			_bmsStatus = message.data[0] & 0x1 ? DischargeEnabled : Unknown;
+			_bmsStatus = OrionBms::DISCHARGE_ENABLED.raw(message.data) ? DischargeEnabled : Unknown;
 			if (_bmsStatus == Unknown)
-				_bmsStatus = message.data[0] & 0x2 ? ChargeEnabled : Unknown;
+				_bmsStatus = OrionBms::CHARGE_ENABLED.raw(message.data) ? ChargeEnabled : Unknown;
 				
 			_fault = _parseFault(message);
-			_validationMap[CAN_ORIONBMS_STATUS] = _lastUpdateTime;
+			_setValid(Status);
+			_setValid(Events);
+			_checkFault();
 			break;
 		case CAN_ORIONBMS_PACK:
-			_batteryVoltage = (float)_parseInt16(message.data) / 10.0f;
-			_batteryCurrent = (float)_parseInt16(message.data + 2) / 10.0f;
-			_soc = (float)message.data[4] / 2.0f;
-			_validationMap[CAN_ORIONBMS_PACK] = _lastUpdateTime;
+			_batteryVoltage = OrionBms::PACK_VOLTAGE.decode(message.data);
+			_batteryCurrent = OrionBms::PACK_CURRENT.decode(message.data);
+			_soc = OrionBms::PACK_SOC.decode(message.data);
+			_setValid(BatteryVoltage);
+			_setValid(BatteryCurrent);
+			_setValid(Soc);
+			_notifyPower();
 			break;
 		case CAN_ORIONBMS_CELL:
 			// TODO: Add unify this with TinyBms
-			_cellVoltageMin = (float)_parseInt16(message.data) / 1000.0f;
-			_cellVoltageMax = (float)_parseInt16(message.data + 2) / 1000.0f;
-			_cellVoltageAvg = (float)_parseInt16(message.data + 4) / 1000.0f;
-			_validationMap[CAN_ORIONBMS_CELL] = _lastUpdateTime;
+			_cellVoltageMin = OrionBms::CELL_VOLTAGE_MIN.decode(message.data);
+			_cellVoltageMax = OrionBms::CELL_VOLTAGE_MAX.decode(message.data);
+			_cellVoltageAvg = OrionBms::CELL_VOLTAGE_AVG.decode(message.data);
+			_setValid(CellVoltageMin);
+			_setValid(CellVoltageMax);
 			break;
 		case CAN_ORIONBMS_TEMP:
-			_batteryTempMin = (int)message.data[0];
-			_batteryTempMax = (int)message.data[1];
-			_batteryTempAvg = (int)message.data[2];
-			_tempBms = (int)message.data[3];
-			_validationMap[CAN_ORIONBMS_TEMP] = _lastUpdateTime;
+			_batteryTempMin = OrionBms::TEMP_BATTERY_MIN.raw(message.data);
+			_batteryTempMax = OrionBms::TEMP_BATTERY_MAX.raw(message.data);
+			_batteryTempAvg = OrionBms::TEMP_BATTERY_AVG.raw(message.data);
+			_tempBms = OrionBms::TEMP_BMS.raw(message.data);
+			_setValid(TempBms);
+			_setValid(TempBattery1);
+			break;
+		case CAN_ORIONBMS_CELL_BROADCAST:
+			if (_validateCellBroadcast(message)) {
+				uint8_t cell = OrionBms::CELL_ID.raw(message.data);
+				if (cell < BMS_MAX_CELLS) {
+					_cells[cell].resistance = OrionBms::CELL_RESISTANCE.raw(message.data);
+					_cells[cell].openVoltage = OrionBms::CELL_OPEN_VOLTAGE.raw(message.data) / 10;
+
+					if (OrionBms::CELL_SHUNTING.raw(message.data)) {
+						_balancingCells |= (1UL << cell);
+					} else {
+						_balancingCells &= ~(1UL << cell);
+					}
+				}
+				_setCellVoltage(cell, OrionBms::CELL_BROADCAST_VOLTAGE.decode(message.data));
+			}
+			break;
+		case CAN_ORIONBMS_LIMITS:
+			_dischargeLimit = OrionBms::PACK_DCL.raw(message.data);
+			_chargeLimit = OrionBms::PACK_CCL.raw(message.data);
+			_setValid(Limits);
 			break;
 		default:
 			// do nothing
@@ -133,10 +205,6 @@ void CanSensorOrionBms::update(CanMessage message) {
 	}
 }
 
-int16_t CanSensorOrionBms::_parseInt16(uint8_t* buf) {
-	return (float)( *buf << 8 | *(buf + 1) );
-}
-
 // Faults are prioritized from left to right, most significant bit to least significant
 // and numbered from 1 (highest) to 19 (lowest).  Please refer to notion for more info
 int CanSensorOrionBms::_parseFault(CanMessage message) {
@@ -156,4 +224,15 @@ int CanSensorOrionBms::_parseFault(CanMessage message) {
 		}
 	}
 	return 0;
+}
+
+bool CanSensorOrionBms::_validateCellBroadcast(CanMessage message) {
+	if (message.dataLength != 8)
+		return false;
+
+	uint8_t checksum = CAN_ORIONBMS_CELL_BROADCAST + message.dataLength;
+	for (int i = 0; i < 7; i++) {
+		checksum += message.data[i];
+	}
+	return checksum == message.data[7];
 }
\ No newline at end of file
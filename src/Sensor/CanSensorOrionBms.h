@@ -4,8 +4,26 @@
 #include "CanSensorBms.h"
 #include "CanInterface.h"
 
+// Orion cell broadcast (one cell per message, cycling through every cell) default id
+#ifndef CAN_ORIONBMS_CELL_BROADCAST
+#define CAN_ORIONBMS_CELL_BROADCAST 0x36
+#endif
+
+// Orion custom message carrying pack discharge and charge current limits (configured in Orion profile)
+#ifndef CAN_ORIONBMS_LIMITS
+#define CAN_ORIONBMS_LIMITS 0x6B4
+#endif
+
 class CanSensorOrionBms : public CanSensorBms {
 	public:
+		/**
+		 * @brief Per-cell data from cell broadcast (voltage is stored in CanSensorBms cell table)
+		 */
+		struct CellData {
+			uint16_t resistance;	// internal resistance (0.01 mOhm)
+			uint16_t openVoltage;	// open circuit voltage (mV)
+		};
+
 		CanSensorOrionBms(CanInterface& canInterface);
 
 		~CanSensorOrionBms();
@@ -85,6 +103,41 @@ class CanSensorOrionBms : public CanSensorBms {
          */
         int getFault(bool& valid = Sensor::dummy) override;
 
+        /**
+         * @brief Get the pack discharge current limit (A)
+         */
+        int getDischargeLimit(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the pack charge current limit (A)
+         */
+        int getChargeLimit(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the internal resistance (0.01 mOhm) of every cell as a compact array (see getCellVoltages)
+         */
+        String getCellResistances(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the open circuit voltage (mV) of every cell as a compact array (see getCellVoltages)
+         */
+        String getCellOpenVoltages(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the cells currently being balanced as a hex bitmask (bit n is cell n)
+         */
+        String getBalancingCells(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the number of cells currently being balanced
+         */
+        int getNumBalancingCells(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get the data of cell at index (0 based) from the cell broadcast
+         */
+        const CellData& getCellData(uint8_t index);
+
         /**
          * @brief Send a restart message to the BMS
          */
@@ -95,6 +148,10 @@ class CanSensorOrionBms : public CanSensorBms {
         int _batteryTempMin = 0;
 		int _batteryTempAvg = 0;
 		float _cellVoltageAvg = 0.0f;
+		uint16_t _dischargeLimit = 0;
+		uint16_t _chargeLimit = 0;
+		CellData _cells[BMS_MAX_CELLS] = { };
+		uint32_t _balancingCells = 0;
 
 		/**
          * @brief Called by delegate in CanInterface when a message with one of Orion's ids is receieved
@@ -103,13 +160,6 @@ class CanSensorOrionBms : public CanSensorBms {
          */
 		void update(CanMessage message) override;
 
-		/**
-		 * @brief parses a big-endian two byte signed integer from buffer
-		 * 
-		 * @param buf pointer to first byte to be read (left to right)
-		 */
-		int16_t _parseInt16(uint8_t* buf);
-
 		/**
 		 * @brief parses fault codes from can message and returns an int representing the highest priority fault
 		 * 
@@ -117,6 +167,11 @@ class CanSensorOrionBms : public CanSensorBms {
 		 * this method must change
 		 */
 		int _parseFault(CanMessage message);
+
+		/**
+		 * @brief Verifies checksum of a cell broadcast message: byte 7 is the sum of id, length and bytes 0 to 6
+		 */
+		bool _validateCellBroadcast(CanMessage message);
 };
 
 #endif
\ No newline at end of file
@@ -1,17 +1,14 @@
 #include "CanSensorSteering.h"
+#include "CanSignals.h"
 #include "settings.h"
 
-#define STEERING_READY_BIT_IGNITION 0x00
-#define STEERING_READY_BIT_DMS      0x01
-#define STEERING_READY_BIT_BRAKE    0x02
-
 CanSensorSteering::CanSensorSteering(CanInterface &canInterface) 
     : CanListener(canInterface) { }
 
 void CanSensorSteering::begin() {
     CanListenerDelegate* steeringDelegate = new CanListener::CanListenerDelegate(this);
-    _canInterface.addMessageListen(CAN_STEERING_THROTTLE, steeringDelegate);
-    _canInterface.addMessageListen(CAN_STEERING_READY, steeringDelegate);
+    _addListen(CAN_STEERING_THROTTLE, steeringDelegate);
+    _addListen(CAN_STEERING_READY, steeringDelegate);
 }
 
 void CanSensorSteering::handle() {
@@ -47,12 +44,12 @@ void CanSensorSteering::update(CanMessage message) {
 
     if(message.id == CAN_STEERING_THROTTLE) {
         _lastUpdateThrottle = millis();
-        _throttle = message.data[0];
+        _throttle = CanSignals::Steering::THROTTLE.raw(message.data);
     } else if(message.id == CAN_STEERING_READY) {
         _lastUpdateReady = millis();
-        _ignition = (message.data[0] >> STEERING_READY_BIT_IGNITION) & 0x01;
-        _dms = (message.data[0] >> STEERING_READY_BIT_DMS) & 0x01;
-        _brake = (message.data[0] >> STEERING_READY_BIT_BRAKE) & 0x01;
+        _ignition = CanSignals::Steering::IGNITION.raw(message.data);
+        _dms = CanSignals::Steering::DMS.raw(message.data);
+        _brake = CanSignals::Steering::BRAKE.raw(message.data);
     }
 
     
@@ -1,9 +1,18 @@
 #include "CanSensorTinyBms.h"
+#include "CanSignals.h"
 #include "settings.h"
 
-#define NUM_PARAMS                  7
+using namespace CanSignals;
+
 #define REQ_DATA_LENGTH     		8
 
+// Time to wait for a response before a request is retried (or given up on after REQ_MAX_RETRIES)
+#define REQ_TIMEOUT_MS              100
+#define REQ_MAX_RETRIES             2
+
+// While asleep, only a status request is sent on this interval (ms) so BmsManager can detect TinyBMS is present
+#define PROBE_INTERVAL_MS           2000
+
 #define PARAM_ID_BATTERY_VOLTAGE    0x14
 #define PARAM_ID_BATTERY_CURRENT    0x15
 #define PARAM_ID_MAX_CELL_VOLTAGE   0x16
@@ -13,6 +22,7 @@
 #define PARAM_ID_TEMP               0x1B
 
 #define PARAM_ID_EVENTS             0x11
+#define PARAM_ID_READ_REGISTER      0x03
 #define PARAM_ID_RESET              0x02
 #define RESET_ID_BMS                0x05
 
@@ -27,9 +37,9 @@
 #define TEMP_ID_BATTERY_1   		0x01
 #define TEMP_ID_BATTERY_2   		0x02
 
-#define RSP_STATUS_BYTE     		0x0
-#define RSP_PARAM_ID_BYTE   		0x1
-#define RSP_DATA_BYTE       		0x2
+// Registers 0 to 15 hold the voltage of cells 1 to 16 (cells which are not connected read 0)
+#define CELL_REGISTER_FIRST         0x00
+#define NUM_CELL_REGISTERS          16
 
 #define FAULT_UNDER_VOLTAGE                 0x02
 #define FAULT_OVER_VOLTAGE                  0x03
@@ -43,60 +53,66 @@
 #define FAULT_CURRENT_SENSOR_DISCONNECTED   0x0E
 #define FAULT_CURRENT_SENSOR_CONNECTED      0x0F
 
-const uint8_t PARAM_IDS[] =  {
-	PARAM_ID_BATTERY_VOLTAGE,
-	PARAM_ID_BATTERY_CURRENT,
-	PARAM_ID_MAX_CELL_VOLTAGE,
-	PARAM_ID_MIN_CELL_VOLTAGE,
-	PARAM_ID_STATUS,
-	PARAM_ID_SOC,
-	PARAM_ID_TEMP
-};
-
-const uint8_t VALIDATION_IDS[] {
-    PARAM_ID_BATTERY_VOLTAGE,
-    PARAM_ID_BATTERY_CURRENT,
-    PARAM_ID_MAX_CELL_VOLTAGE,
-    PARAM_ID_MIN_CELL_VOLTAGE,
-    PARAM_ID_STATUS,
-    PARAM_ID_SOC,
-    PARAM_ID_TEMP,
-    TEMP_ID_INTERNAL,
-    TEMP_ID_BATTERY_1,
-    TEMP_ID_BATTERY_2,
-    PARAM_ID_EVENTS
+// Parameters requested by the scheduler and the period (ms) at which each should be refreshed:
+// most overdue request (relative to its period) is sent first, so shorter periods get higher priority
+// NOTE: PARAM_ID_EVENTS is only requested while bms status is FaultError
+const CanSensorTinyBms::ParamRequest PARAM_REQUESTS[TINYBMS_NUM_REQUESTS] = {
+	{ PARAM_ID_BATTERY_CURRENT, 50 },
+	{ PARAM_ID_BATTERY_VOLTAGE, 100 },
+	{ PARAM_ID_STATUS, 250 },
+	{ PARAM_ID_MAX_CELL_VOLTAGE, 250 },
+	{ PARAM_ID_MIN_CELL_VOLTAGE, 250 },
+	{ PARAM_ID_EVENTS, 500 },
+	{ PARAM_ID_READ_REGISTER, 200 },
+	{ PARAM_ID_SOC, 1000 },
+	{ PARAM_ID_TEMP, 1000 }
 };
 
-CanSensorTinyBms::CanSensorTinyBms(CanInterface &canInterface, uint16_t requestIntervalMs) 
-    : CanSensorBms(canInterface, CAN_TINYBMS_RESPONSE), _requestIntervalMs(requestIntervalMs) {
-		for (uint16_t id : VALIDATION_IDS)  {
-        	_validationMap[id] = 0;
-    	}
+CanSensorTinyBms::CanSensorTinyBms(CanInterface &canInterface, uint16_t requestIntervalMs, uint8_t maxOutstanding) 
+    : CanSensorBms(canInterface, CAN_TINYBMS_RESPONSE), _requestIntervalMs(requestIntervalMs), _maxOutstanding(maxOutstanding) {
+		for (uint8_t i = 0; i < TINYBMS_NUM_REQUESTS; i++) {
+			_requests[i] = { 0, 0, false, 0 };
+		}
+		_stats = { 0, 0, 0, 0, UINT32_MAX, 0, 0 };
     }
 
 void CanSensorTinyBms::handle() {
-    if(millis() - _lastValidTime >= _requestIntervalMs) {
+    unsigned long time = millis();
 
-        CanMessage msg = CAN_MESSAGE_NULL;
-        msg.id = CAN_TINYBMS_REQUEST;
-        msg.dataLength = REQ_DATA_LENGTH;
+    if (_isAsleep) {
+        _probe(time);
+        return;
+    }
 
-        if(_bmsStatus == FaultError) {
-            msg.data[0] = PARAM_ID_EVENTS;
-            _canInterface.sendMessage(msg);
-        }
+    _checkTimeouts(time);
 
-        msg.data[0] = PARAM_IDS[_currentParam];
-            
-        _canInterface.sendMessage(msg);
+    if(_numOutstanding < _maxOutstanding && time - _lastRequestTime >= _requestIntervalMs) {
+        int next = _nextRequest(time);
 
-        if(_currentParam == NUM_PARAMS - 1) {
-            _currentParam = 0;
-        } else {
-            _currentParam++;
-        }
+        if(next >= 0) {
+            CanMessage msg = CAN_MESSAGE_NULL;
+            msg.id = CAN_TINYBMS_REQUEST;
+            msg.dataLength = REQ_DATA_LENGTH;
+            msg.data[0] = PARAM_REQUESTS[next].paramId;
 
-        _lastValidTime = millis();
+            // one cell is read per request: a full sweep takes NUM_CELL_REGISTERS * 200 ms
+            if (msg.data[0] == PARAM_ID_READ_REGISTER) {
+                uint16_t address = CELL_REGISTER_FIRST + _nextCell;
+                msg.data[1] = 1;
+                msg.data[2] = address & 0xFF;
+                msg.data[3] = address >> 8;
+                _nextCell = (_nextCell + 1) % NUM_CELL_REGISTERS;
+            }
+            _canInterface.sendMessage(msg);
+
+            RequestState& request = _requests[next];
+            request.outstanding = true;
+            request.lastRequested = time;
+            request.sentMicros = micros();
+            _numOutstanding++;
+            _stats.requests++;
+            _lastRequestTime = time;
+        }
     }
 
 	CanSensorBms::handle();
@@ -107,67 +123,67 @@ String CanSensorTinyBms::getHumanName() {
 }
 
 String CanSensorTinyBms::getBatteryVolt(bool& valid) {
-    valid  = _validate(PARAM_ID_BATTERY_VOLTAGE);
+    valid  = _validate(BatteryVoltage);
     return FLOAT_TO_STRING(_batteryVoltage, 1);
 }
 
 String CanSensorTinyBms::getBatteryCurrent(bool& valid) {
-    valid  = _validate(PARAM_ID_BATTERY_CURRENT);
+    valid  = _validate(BatteryCurrent);
     return FLOAT_TO_STRING(_batteryCurrent, 1);
 }
 
 String CanSensorTinyBms::getMinVolt(bool& valid) {
-    valid  = _validate(PARAM_ID_MIN_CELL_VOLTAGE);
+    valid  = _validate(CellVoltageMin);
     return FLOAT_TO_STRING(_cellVoltageMin, 3);
 }
 
 String CanSensorTinyBms::getMaxVolt(bool& valid) {
-    valid  = _validate(PARAM_ID_MAX_CELL_VOLTAGE);
+    valid  = _validate(CellVoltageMax);
     return FLOAT_TO_STRING(_cellVoltageMax, 3);
 }
 
 String CanSensorTinyBms::getAvgVolt(bool& valid) {
-	valid = _validate(PARAM_ID_MIN_CELL_VOLTAGE) && _validate(PARAM_ID_MAX_CELL_VOLTAGE);
+	valid = _validate(CellVoltageMin) && _validate(CellVoltageMax);
 	return FLOAT_TO_STRING((_cellVoltageMin + _cellVoltageMax) / 2.0f, 3);
 }
 
 String CanSensorTinyBms::getSoc(bool& valid) {
-    valid  = _validate(PARAM_ID_SOC);
+    valid  = _validate(Soc);
     return FLOAT_TO_STRING(_soc, 1); 
 }
 
 int CanSensorTinyBms::getTempBms(bool& valid) {
-    valid  = _validate(TEMP_ID_INTERNAL);
+    valid  = _validate(TempBms);
     return _tempBms;
 }
 
 int CanSensorTinyBms::getMinBatteryTemp(bool& valid) {
-    valid  = _validate(TEMP_ID_BATTERY_1)  && _validate(TEMP_ID_BATTERY_2);
+    valid  = _validate(TempBattery1)  && _validate(TempBattery2);
     return min(_batteryTemp1, _batteryTemp2);
 }
 
 int CanSensorTinyBms::getMaxBatteryTemp(bool& valid) {
-    valid  = _validate(TEMP_ID_BATTERY_1)  && _validate(TEMP_ID_BATTERY_2);
+    valid  = _validate(TempBattery1)  && _validate(TempBattery2);
     return max(_batteryTemp1, _batteryTemp2);
 }
 
 int CanSensorTinyBms::getAvgBatteryTemp(bool& valid) {
-	valid  = _validate(TEMP_ID_BATTERY_1) && _validate(TEMP_ID_BATTERY_2);
+	valid  = _validate(TempBattery1) && _validate(TempBattery2);
     return (_batteryTemp1 + _batteryTemp2) / 2;
 }
 
 int CanSensorTinyBms::getStatusBms(bool& valid) {
-    valid  = _validate(PARAM_ID_STATUS);
+    valid  = _validate(Status);
     return _bmsStatus;
 }
 
 String CanSensorTinyBms::getStatusBmsString(bool& valid) {
-    valid  = _validate(PARAM_ID_STATUS);
+    valid  = _validate(Status);
     return String(BMS_STATUS_STRINGS[_bmsStatus]);
 }
 
 int CanSensorTinyBms::getFault(bool& valid) {
-    valid = _validate(PARAM_ID_STATUS) && _validate(PARAM_ID_EVENTS);
+    valid = _validate(Status) && _validate(Events);
 
     if(_bmsStatus == FaultError) {
         return _getFaultCode(_fault);
@@ -185,30 +201,50 @@ void CanSensorTinyBms::restart() {
     _canInterface.sendMessage(msg);
 }
 
+String CanSensorTinyBms::getResponseLatency(bool& valid) {
+    valid = _stats.responses > 0;
+    return valid ? FLOAT_TO_STRING((float)_stats.totalLatencyMicros / _stats.responses / 1000.0f, 2) : "0";
+}
+
+int CanSensorTinyBms::getResponseTimeouts(bool& valid) {
+    valid = true;
+    return _stats.timeouts;
+}
+
+const CanSensorTinyBms::RequestStats& CanSensorTinyBms::getRequestStats() {
+    return _stats;
+}
+
 void CanSensorTinyBms::update(CanMessage message) {
 	_lastUpdateTime = millis();
 	
-    if(message.data[RSP_STATUS_BYTE] != TRUE) {
+    if(TinyBms::STATUS.raw(message.data) != TRUE) {
         DEBUG_SERIAL_LN("Poor BMS Data Received");
     }
     else {
-        uint8_t id = message.data[RSP_PARAM_ID_BYTE];
+        uint8_t id = TinyBms::PARAM_ID.raw(message.data);
+        _completeRequest(id);
+
         switch (id) {
             case PARAM_ID_BATTERY_VOLTAGE:
-                _batteryVoltage = parseFloat(message.data);
+                _batteryVoltage = TinyBms::BATTERY_VOLTAGE.decode(message.data);
+                _setValid(BatteryVoltage);
                 break;
             case PARAM_ID_BATTERY_CURRENT:
-                // tiny bms returns -A for discharging and +A for charging: we want the inverse so flip sign here
-                _batteryCurrent = -parseFloat(message.data);
+                _batteryCurrent = TinyBms::BATTERY_CURRENT.decode(message.data);
+                _setValid(BatteryCurrent);
+                _notifyPower();
                 break;
             case PARAM_ID_MAX_CELL_VOLTAGE:
-                _cellVoltageMax = (float)parseInt16(message.data) / 1000.0; 
+                _cellVoltageMax = TinyBms::CELL_VOLTAGE.decode(message.data);
+                _setValid(CellVoltageMax);
                 break;
             case PARAM_ID_MIN_CELL_VOLTAGE:
-                _cellVoltageMin = (float)parseInt16(message.data) / 1000.0; 
+                _cellVoltageMin = TinyBms::CELL_VOLTAGE.decode(message.data);
+                _setValid(CellVoltageMin);
                 break;
             case PARAM_ID_STATUS: {
-                unsigned statusCode = parseInt16(message.data);
+                unsigned statusCode = TinyBms::ONLINE_STATUS.raw(message.data);
                 if(statusCode == STATUS_CHARGING) {
                     _bmsStatus = Charging;
                 }
@@ -228,57 +264,138 @@ void CanSensorTinyBms::update(CanMessage message) {
                 {
                     _bmsStatus = FaultError;
                 }
+                _setValid(Status);
+                _checkFault();
                 break;
             }
             case PARAM_ID_SOC:
-                _soc = (float)parseInt32(message.data) / 1000000.0;
+                _soc = TinyBms::SOC.decode(message.data);
+                _setValid(Soc);
                 break;
-            case PARAM_ID_TEMP:
-                if(message.data[5] == TEMP_ID_INTERNAL) {
-                    _tempBms = parseInt16(message.data + 1) / 10;
-                    _validationMap[TEMP_ID_INTERNAL] = _lastUpdateTime;
+            case PARAM_ID_TEMP: {
+                uint8_t tempId = TinyBms::TEMP_ID.raw(message.data);
+                int temp = TinyBms::TEMP.decode(message.data);
+                if(tempId == TEMP_ID_INTERNAL) {
+                    _tempBms = temp;
+                    _setValid(TempBms);
                 }
-                else if(message.data[5] == TEMP_ID_BATTERY_1) {
-                    _batteryTemp1 = parseInt16(message.data + 1) / 10;
-                    _validationMap[TEMP_ID_BATTERY_1] = _lastUpdateTime;
+                else if(tempId == TEMP_ID_BATTERY_1) {
+                    _batteryTemp1 = temp;
+                    _setValid(TempBattery1);
                 }
-                else if(message.data[5] == TEMP_ID_BATTERY_2) {
-                    _batteryTemp2 = parseInt16(message.data + 1) / 10;
-                    _validationMap[TEMP_ID_BATTERY_2] = _lastUpdateTime;
+                else if(tempId == TEMP_ID_BATTERY_2) {
+                    _batteryTemp2 = temp;
+                    _setValid(TempBattery2);
+                }
+                break;
+            }
+            case PARAM_ID_READ_REGISTER: {
+                uint16_t address = TinyBms::REGISTER_ADDRESS.raw(message.data);
+                if (address >= CELL_REGISTER_FIRST && address < CELL_REGISTER_FIRST + NUM_CELL_REGISTERS) {
+                    _setCellVoltage(address - CELL_REGISTER_FIRST, TinyBms::CELL_REGISTER_VOLTAGE.decode(message.data));
                 }
                 break;
+            }
             case PARAM_ID_EVENTS:
-                if(message.data[7] == 1 && message.data[6] <= 0x0F) {
-                    _fault = message.data[6];
+                if(TinyBms::EVENT_FLAG.raw(message.data) == 1 && TinyBms::EVENT_ID.raw(message.data) <= 0x0F) {
+                    _fault = TinyBms::EVENT_ID.raw(message.data);
                 }
+                _setValid(Events);
+                _checkFault();
                 break; 
             default:
                 break;
         }
+    }
+}
 
-		// update validation map--exclude temp because it needs special handling for 3 cases
-		if (id != PARAM_ID_TEMP && _validationMap.find(id) != _validationMap.end()) {
-			_validationMap[id] = _lastUpdateTime;
-		}
+void CanSensorTinyBms::_probe(unsigned long time) {
+    // responses aren't dispatched while asleep: drop outstanding requests so scheduling restarts cleanly on wake
+    if (_numOutstanding > 0) {
+        for (uint8_t i = 0; i < TINYBMS_NUM_REQUESTS; i++) {
+            _requests[i].outstanding = false;
+            _requests[i].retries = 0;
+        }
+        _numOutstanding = 0;
+    }
+
+    if (time - _lastRequestTime >= PROBE_INTERVAL_MS) {
+        CanMessage msg = CAN_MESSAGE_NULL;
+        msg.id = CAN_TINYBMS_REQUEST;
+        msg.dataLength = REQ_DATA_LENGTH;
+        msg.data[0] = PARAM_ID_STATUS;
+        _canInterface.sendMessage(msg);
+        _lastRequestTime = time;
     }
 }
 
-float CanSensorTinyBms::parseFloat(uint8_t* dataPtr) {
-    float output;
-    memcpy((void*)&output, (void*)(dataPtr + RSP_DATA_BYTE), 4);
-    return output;
+int CanSensorTinyBms::_nextRequest(unsigned long time) {
+    int next = -1;
+    uint32_t nextUrgency = 0;
+
+    for (uint8_t i = 0; i < TINYBMS_NUM_REQUESTS; i++) {
+        const RequestState& request = _requests[i];
+        if (request.outstanding || (PARAM_REQUESTS[i].paramId == PARAM_ID_EVENTS && _bmsStatus != FaultError)) {
+            continue;
+        }
+
+        // urgency is elapsed time relative to period: > 256 means request is overdue (retries are always due),
+        // scaled in 64 bits so requests skipped for hours (fault events) don't wrap around to "not due"
+        uint32_t elapsed = time - request.lastRequested;
+        uint64_t scaled = ((uint64_t)elapsed * 256) / PARAM_REQUESTS[i].periodMs;
+        uint32_t urgency = request.retries > 0 ? UINT32_MAX : (uint32_t)min(scaled, (uint64_t)(UINT32_MAX - 1));
+        if (urgency >= 256 && urgency > nextUrgency) {
+            next = i;
+            nextUrgency = urgency;
+        }
+    }
+
+    return next;
 }
 
-uint16_t CanSensorTinyBms::parseInt16(uint8_t* dataPtr) {
-    return ((uint16_t)dataPtr[RSP_DATA_BYTE + 1] << 8)
-            | dataPtr[RSP_DATA_BYTE];
+void CanSensorTinyBms::_checkTimeouts(unsigned long time) {
+    for (uint8_t i = 0; i < TINYBMS_NUM_REQUESTS; i++) {
+        RequestState& request = _requests[i];
+        if (!request.outstanding || time - request.lastRequested < REQ_TIMEOUT_MS) {
+            continue;
+        }
+
+        request.outstanding = false;
+        _numOutstanding--;
+        _stats.timeouts++;
+
+        // retry immediately, or give up and wait for the next period
+        if (request.retries < REQ_MAX_RETRIES) {
+            request.retries++;
+            _stats.retries++;
+        } else {
+            request.retries = 0;
+        }
+    }
 }
 
-uint32_t CanSensorTinyBms::parseInt32(uint8_t* dataPtr) {
-    return ((uint32_t)dataPtr[RSP_DATA_BYTE + 3] << 24) 
-            | ((uint32_t)dataPtr[RSP_DATA_BYTE + 2] << 16)
-            | ((uint32_t)dataPtr[RSP_DATA_BYTE + 1] << 8)
-            | dataPtr[RSP_DATA_BYTE];
+void CanSensorTinyBms::_completeRequest(uint8_t paramId) {
+    for (uint8_t i = 0; i < TINYBMS_NUM_REQUESTS; i++) {
+        RequestState& request = _requests[i];
+        if (PARAM_REQUESTS[i].paramId != paramId || !request.outstanding) {
+            continue;
+        }
+
+        uint32_t latency = micros() - request.sentMicros;
+        request.outstanding = false;
+        request.retries = 0;
+        _numOutstanding--;
+
+        _stats.responses++;
+        _stats.totalLatencyMicros += latency;
+        if (latency < _stats.minLatencyMicros) {
+            _stats.minLatencyMicros = latency;
+        }
+        if (latency > _stats.maxLatencyMicros) {
+            _stats.maxLatencyMicros = latency;
+        }
+        return;
+    }
 }
 
 uint8_t CanSensorTinyBms::_getFaultCode(uint8_t fault) {
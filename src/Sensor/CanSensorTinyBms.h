@@ -1,21 +1,45 @@
 #ifndef _CAN_SENSOR_TINY_BMS_H_
 #define _CAN_SENSOR_TINY_BMS_H_
 
-#include <map>
 #include "CanSensorBms.h"
 #include "BmsFault.h"
 
+// Number of parameters requested from TinyBMS (see PARAM_REQUESTS)
+#define TINYBMS_NUM_REQUESTS 9
+
 using namespace can;
 
 class CanSensorTinyBms : public CanSensorBms {
     public:    
+        /**
+         * @brief Parameter requested from TinyBMS and the period (ms) at which it should be refreshed
+         */
+        struct ParamRequest {
+            uint8_t paramId;
+            uint16_t periodMs;
+        };
+
+        /**
+         * @brief Request-to-response statistics since startup
+         */
+        struct RequestStats {
+            uint32_t requests;
+            uint32_t responses;
+            uint32_t timeouts;
+            uint32_t retries;
+            uint32_t minLatencyMicros;
+            uint32_t maxLatencyMicros;
+            uint64_t totalLatencyMicros;
+        };
+
         /**
          * @brief Constructor for CanSensorTinyBms
          * 
          * @param canInterface - the can interface which will be reading data from Can buffer
-         * @param requestIntervalMs - frequency to request Bms data
+         * @param requestIntervalMs - minimum time between consecutive requests to Bms
+         * @param maxOutstanding - maximum number of requests awaiting a response at once
          */
-        CanSensorTinyBms(CanInterface &canInterface, uint16_t requestIntervalMs);
+        CanSensorTinyBms(CanInterface &canInterface, uint16_t requestIntervalMs, uint8_t maxOutstanding = 2);
 
 		/**
          * @brief Get the battery voltage
@@ -78,7 +102,25 @@ class CanSensorTinyBms : public CanSensorBms {
         String getStatusBmsString(bool& valid = Sensor::dummy) override;
 
         /**
-         * @brief Repeatedly requests and stores bms data on interval
+         * @brief Average time (ms) between a request being sent and its response being received
+         */
+        String getResponseLatency(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Number of requests which have not received a response within timeout
+         */
+        int getResponseTimeouts(bool& valid = Sensor::dummy);
+
+        /**
+         * @brief Get request-to-response statistics since startup
+         */
+        const RequestStats& getRequestStats();
+
+        /**
+         * @brief Sends the most overdue parameter request whenever fewer than maxOutstanding requests
+         * are awaiting a response, and retries requests which have timed out
+         * 
+         * @note while asleep, only a slow presence probe is sent
          */
         void handle() override;
         
@@ -98,40 +140,53 @@ class CanSensorTinyBms : public CanSensorBms {
         void restart() override;
 
     private:
+        // Request pipeline state, indexed the same as PARAM_REQUESTS
+        struct RequestState {
+            unsigned long lastRequested;
+            uint32_t sentMicros;
+            bool outstanding;
+            uint8_t retries;
+        };
+
 		// Control
         const uint16_t _requestIntervalMs;
-        unsigned long _lastValidTime = 0;
-        uint8_t _currentParam = 0;
+        const uint8_t _maxOutstanding;
+        unsigned long _lastRequestTime = 0;
+        uint8_t _numOutstanding = 0;
+        RequestState _requests[TINYBMS_NUM_REQUESTS];
+        RequestStats _stats;
+        uint8_t _nextCell = 0;
 		int _batteryTemp1 = 0;
 		int _batteryTemp2 = 0;
 
         /**
-         * @brief Parse number in TinyBMS Float format
+         * @brief Determines type of bms data and stores respectively
          * 
-         * @param dataPtr Base address of data
+         * @param message data byte to be added to internal can message
          */
-        float parseFloat(uint8_t* dataPtr);
+        void update(CanMessage message) override;
 
         /**
-         * @brief Parse number in TinyBMS 16-bit int format
-         * 
-         * @param dataPtr Base address of data
+         * @brief Sends a status request every PROBE_INTERVAL_MS (used while asleep)
          */
-        uint16_t parseInt16(uint8_t* dataPtr);
+        void _probe(unsigned long time);
 
         /**
-         * @brief Parse number in TinyBMS 32-bit int format
-         * 
-         * @param dataPtr Base address of data
+         * @brief Returns index of the request which is most overdue, or -1 if no request is due
          */
-        uint32_t parseInt32(uint8_t* dataPtr);
+        int _nextRequest(unsigned long time);
 
         /**
-         * @brief Determines type of bms data and stores respectively
+         * @brief Frees outstanding requests which have timed out and schedules their retry
+         */
+        void _checkTimeouts(unsigned long time);
+
+        /**
+         * @brief Matches a response to its outstanding request and records its latency
          * 
-         * @param message data byte to be added to internal can message
+         * @param paramId parameter id of the response
          */
-        void update(CanMessage message) override;
+        void _completeRequest(uint8_t paramId);
 
         /**
          * @brief Converts TinyBMS fault code into universal fault code
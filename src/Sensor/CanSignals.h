@@ -0,0 +1,76 @@
+#ifndef _CAN_SIGNALS_H_
+#define _CAN_SIGNALS_H_
+
+#include "CanSignal.h"
+
+using namespace can;
+
+/**
+ * Signal database for the can-common message ids decoded by telemetry
+ * 
+ * Each entry is { startBit, length, byte order, value type, scale, offset } (see CanSignal.h for bit numbering).
+ * To decode a new message, add its signals here and call decode()/raw() on them in the listener's update()
+ **/
+namespace CanSignals {
+
+	// CAN_STEERING_THROTTLE and CAN_STEERING_READY
+	namespace Steering {
+		constexpr CanSignal THROTTLE            { 0, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal IGNITION            { 0, 1, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal DMS                 { 1, 1, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal BRAKE               { 2, 1, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+	}
+
+	// CAN_ORIONBMS_STATUS, CAN_ORIONBMS_PACK, CAN_ORIONBMS_CELL, CAN_ORIONBMS_TEMP, CAN_ORIONBMS_CELL_BROADCAST and CAN_ORIONBMS_LIMITS (big endian)
+	namespace OrionBms {
+		constexpr CanSignal DISCHARGE_ENABLED   { 7, 1, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal CHARGE_ENABLED      { 6, 1, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+
+		constexpr CanSignal PACK_VOLTAGE        { 0, 16, CanSignal::BigEndian, CanSignal::Signed, 0.1f, 0.0f };
+		constexpr CanSignal PACK_CURRENT        { 16, 16, CanSignal::BigEndian, CanSignal::Signed, 0.1f, 0.0f };
+		constexpr CanSignal PACK_SOC            { 32, 8, CanSignal::BigEndian, CanSignal::Unsigned, 0.5f, 0.0f };
+
+		constexpr CanSignal CELL_VOLTAGE_MIN    { 0, 16, CanSignal::BigEndian, CanSignal::Signed, 0.001f, 0.0f };
+		constexpr CanSignal CELL_VOLTAGE_MAX    { 16, 16, CanSignal::BigEndian, CanSignal::Signed, 0.001f, 0.0f };
+		constexpr CanSignal CELL_VOLTAGE_AVG    { 32, 16, CanSignal::BigEndian, CanSignal::Signed, 0.001f, 0.0f };
+
+		constexpr CanSignal TEMP_BATTERY_MIN    { 0, 8, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal TEMP_BATTERY_MAX    { 8, 8, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal TEMP_BATTERY_AVG    { 16, 8, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal TEMP_BMS            { 24, 8, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+
+		constexpr CanSignal CELL_ID             { 0, 8, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal CELL_BROADCAST_VOLTAGE { 8, 16, CanSignal::BigEndian, CanSignal::Unsigned, 0.0001f, 0.0f };
+		constexpr CanSignal CELL_SHUNTING       { 24, 1, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal CELL_RESISTANCE     { 25, 15, CanSignal::BigEndian, CanSignal::Unsigned, 0.01f, 0.0f };
+		constexpr CanSignal CELL_OPEN_VOLTAGE   { 40, 16, CanSignal::BigEndian, CanSignal::Unsigned, 0.0001f, 0.0f };
+
+		constexpr CanSignal PACK_DCL            { 0, 16, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal PACK_CCL            { 16, 16, CanSignal::BigEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+	}
+
+	// CAN_TINYBMS_RESPONSE (little endian): byte 0 is the response status, byte 1 the requested parameter id
+	namespace TinyBms {
+		constexpr CanSignal STATUS              { 0, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal PARAM_ID            { 8, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+
+		constexpr CanSignal BATTERY_VOLTAGE     { 16, 32, CanSignal::LittleEndian, CanSignal::Float32, 1.0f, 0.0f };
+		// tiny bms returns -A for discharging and +A for charging: we want the inverse so flip sign here
+		constexpr CanSignal BATTERY_CURRENT     { 16, 32, CanSignal::LittleEndian, CanSignal::Float32, -1.0f, 0.0f };
+		constexpr CanSignal CELL_VOLTAGE        { 16, 16, CanSignal::LittleEndian, CanSignal::Unsigned, 0.001f, 0.0f };
+		constexpr CanSignal ONLINE_STATUS       { 16, 16, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal SOC                 { 16, 32, CanSignal::LittleEndian, CanSignal::Unsigned, 0.000001f, 0.0f };
+
+		constexpr CanSignal TEMP                { 24, 16, CanSignal::LittleEndian, CanSignal::Signed, 0.1f, 0.0f };
+		constexpr CanSignal TEMP_ID             { 40, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+
+		constexpr CanSignal EVENT_ID            { 48, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal EVENT_FLAG          { 56, 8, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+
+		// response to a single register read: bytes 2-3 register address, bytes 4-5 register value
+		constexpr CanSignal REGISTER_ADDRESS    { 16, 16, CanSignal::LittleEndian, CanSignal::Unsigned, 1.0f, 0.0f };
+		constexpr CanSignal CELL_REGISTER_VOLTAGE { 32, 16, CanSignal::LittleEndian, CanSignal::Unsigned, 0.0001f, 0.0f };
+	}
+}
+
+#endif
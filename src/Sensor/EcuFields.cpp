@@ -0,0 +1,9 @@
+#include "EcuFields.h"
+
+void decodeEcuFields(const uint8_t* frame, float* values) {
+    for (uint8_t i = 0; i < ECU_NUM_FIELDS; i++) {
+        const EcuField& field = ECU_FIELDS[i];
+        uint16_t raw = ((uint16_t)frame[field.position] << 8) | frame[field.position + 1];
+        values[i] = raw * field.factor + field.offset;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef _ECU_FIELDS_H_
+#define _ECU_FIELDS_H_
+
+#include "EcuFrameParser.h"
+
+/**
+ * @brief Describes one field of the ECU data frame: value = (frame[position] * 256 + frame[position + 1]) * factor + offset
+ **/
+struct EcuField {
+    enum Type { Int, Fixed };
+
+    const char* key;        // logging property name
+    uint8_t position;       // index of high byte in frame
+    float factor;
+    float offset;
+    Type type;              // logged as int, or as a string with decimals
+    uint8_t decimals;
+    uint16_t interval;      // logging interval (s)
+};
+
+/**
+ * @brief ECU frame fields, in the order of SensorEcu::FieldId: decoding and logging commands are generated from this table
+ **/
+constexpr EcuField ECU_FIELDS[] = {
+    //  key      pos  factor    offset  type             decimals interval
+    {   "rpm",   6,   0.25,     0.0,    EcuField::Int,   0,       1   },  // Engine Speed, RPM
+    {   "map",   8,   0.0039,   0.0,    EcuField::Fixed, 2,       1   },  // Manifold Absolute Pressure, kPa
+    {   "tps",   10,  0.0015,   0.0,    EcuField::Int,   0,       1   },  // Throttle Position Sensor, %
+    {   "ect",   12,  1,        -40.0,  EcuField::Int,   0,       5   },  // Engine Coolant Temperature, DegC
+    {   "iat",   14,  1,        -40.0,  EcuField::Int,   0,       5   },  // Intake Air Temperature, DegC
+    {   "o2s",   16,  0.0048,   0.0,    EcuField::Fixed, 2,       1   },  // Oxygen Sensor, V
+    {   "spar",  18,  0.5,      0.0,    EcuField::Int,   0,       1   },  // Spark (Advance/Retard), CrA
+    {   "pw1",   20,  0.001,    0.0,    EcuField::Fixed, 3,       1   },  // Fuel Injector 1 Pulse Width, ms
+    {   "pw2",   22,  0.001,    0.0,    EcuField::Fixed, 3,       1   },  // Fuel Injector 2 Pulse Width, ms
+    {   "ubadc", 24,  0.00625,  0.0,    EcuField::Fixed, 1,       10  }   // Battery Voltage, V
+};
+
+#define ECU_NUM_FIELDS (sizeof(ECU_FIELDS) / sizeof(ECU_FIELDS[0]))
+
+/**
+ * @return true if every field lies in the data bytes of the frame (after service id, before checksum)
+ **/
+constexpr bool ecuFieldsInFrame(uint8_t i = 0) {
+    return i >= ECU_NUM_FIELDS || (ECU_FIELDS[i].position > 4 && ECU_FIELDS[i].position + 1 < ECU_PACKET_SIZE - 1 && ecuFieldsInFrame(i + 1));
+}
+static_assert(ecuFieldsInFrame(), "ECU field outside frame data");
+
+/**
+ * @brief Decodes every field of a valid frame
+ *
+ * @param frame ECU_PACKET_SIZE bytes (see EcuFrameParser::getFrame)
+ * @param values ECU_NUM_FIELDS values, in the order of ECU_FIELDS
+ **/
+void decodeEcuFields(const uint8_t* frame, float* values);
+
+#endif
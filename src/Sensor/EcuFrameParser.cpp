@@ -0,0 +1,80 @@
+#include "EcuFrameParser.h"
+
+// Fixed leading bytes of every frame
+const uint8_t ECU_FRAME_START[] = { ECU_HEADER_1, ECU_HEADER_2, ECU_HEADER_3, ECU_DATA_FIELD_LENGTH, ECU_SERVICE_ID };
+#define ECU_FRAME_START_SIZE    sizeof(ECU_FRAME_START)
+
+bool EcuFrameParser::add(uint8_t byte) {
+    _ring[(_tail + _count) % ECU_RING_SIZE] = byte;
+    _count++;
+
+    while (_count > 0) {
+        if (!_headerMatches()) {
+            // not a frame start: drop oldest byte and retry from the next one
+            _tail = (_tail + 1) % ECU_RING_SIZE;
+            _count--;
+            _skippedBytes++;
+            continue;
+        }
+
+        if (_count < ECU_PACKET_SIZE) {
+            return false;
+        }
+
+        uint8_t checksum = 0;
+        for (uint8_t i = 0; i < ECU_PACKET_SIZE - 1; i++) {
+            checksum += _at(i);
+        }
+
+        if (checksum == _at(ECU_PACKET_SIZE - 1)) {
+            for (uint8_t i = 0; i < ECU_PACKET_SIZE; i++) {
+                _frame[i] = _at(i);
+            }
+            _tail = (_tail + ECU_PACKET_SIZE) % ECU_RING_SIZE;
+            _count -= ECU_PACKET_SIZE;
+            _goodFrames++;
+            return true;
+        }
+
+        // bad frame: a real header may start inside it
+        _badFrames++;
+        _tail = (_tail + 1) % ECU_RING_SIZE;
+        _count--;
+    }
+    return false;
+}
+
+const uint8_t* EcuFrameParser::getFrame() {
+    return _frame;
+}
+
+void EcuFrameParser::reset() {
+    _tail = 0;
+    _count = 0;
+}
+
+uint32_t EcuFrameParser::getGoodFrames() {
+    return _goodFrames;
+}
+
+uint32_t EcuFrameParser::getBadFrames() {
+    return _badFrames;
+}
+
+uint32_t EcuFrameParser::getSkippedBytes() {
+    return _skippedBytes;
+}
+
+uint8_t EcuFrameParser::_at(uint8_t index) {
+    return _ring[(_tail + index) % ECU_RING_SIZE];
+}
+
+bool EcuFrameParser::_headerMatches() {
+    uint8_t length = min(_count, (uint8_t)ECU_FRAME_START_SIZE);
+    for (uint8_t i = 0; i < length; i++) {
+        if (_at(i) != ECU_FRAME_START[i]) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef _ECU_FRAME_PARSER_H_
+#define _ECU_FRAME_PARSER_H_
+
+#include "Particle.h"
+
+#define ECU_PACKET_SIZE         27
+
+#define ECU_HEADER_1            0x80
+#define ECU_HEADER_2            0x8F
+#define ECU_HEADER_3            0xEA
+#define ECU_DATA_FIELD_LENGTH   0x16
+#define ECU_SERVICE_ID          0x50
+
+// Ring buffer size, power of 2 larger than ECU_PACKET_SIZE
+#define ECU_RING_SIZE           32
+
+/**
+ * @brief Byte-wise parser for ECU serial frames
+ *
+ * Frame: header (0x80 0x8F 0xEA), data field length (0x16), service id (0x50), 21 data bytes,
+ * checksum (sum of previous 26 bytes). Bytes are kept in a ring buffer until they are either part of a valid frame
+ * or can't start one: after a bad checksum the parser resumes the header search at the next byte, so a frame
+ * that starts inside a corrupted one is still found.
+ */
+class EcuFrameParser {
+    public:
+        /**
+         * @brief Adds a received byte
+         *
+         * @return true if a valid frame was completed (see getFrame)
+         */
+        bool add(uint8_t byte);
+
+        /**
+         * @return Last valid frame (ECU_PACKET_SIZE bytes)
+         */
+        const uint8_t* getFrame();
+
+        /**
+         * @brief Discards buffered bytes (ie. after the serial buffer overflowed)
+         */
+        void reset();
+
+        /**
+         * @return Number of valid frames since startup
+         */
+        uint32_t getGoodFrames();
+
+        /**
+         * @return Number of frames with a valid header and a bad checksum since startup
+         */
+        uint32_t getBadFrames();
+
+        /**
+         * @return Number of bytes discarded while searching for a header since startup
+         */
+        uint32_t getSkippedBytes();
+
+    private:
+        uint8_t _ring[ECU_RING_SIZE];
+        uint8_t _tail = 0;
+        uint8_t _count = 0;
+        uint8_t _frame[ECU_PACKET_SIZE];
+
+        uint32_t _goodFrames = 0;
+        uint32_t _badFrames = 0;
+        uint32_t _skippedBytes = 0;
+
+        /**
+         * @return byte at position index from the oldest buffered byte
+         */
+        uint8_t _at(uint8_t index);
+
+        /**
+         * @return true if the buffered bytes so far can be the start of a frame
+         */
+        bool _headerMatches();
+};
+
+#endif
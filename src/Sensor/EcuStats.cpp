@@ -0,0 +1,54 @@
+#include "EcuStats.h"
+#include "CompactEncoder.h"
+
+void EcuStats::add(float rpm, float tps, float spark, uint32_t dt) {
+    uint16_t rpmRounded = (uint16_t)lroundf(rpm);
+    int16_t sparkHalfDegrees = (int16_t)lroundf(spark * 2.0f);
+
+    if (_numFrames == 0) {
+        _rpmMin = _rpmMax = rpmRounded;
+        _sparkMin = _sparkMax = sparkHalfDegrees;
+    } else {
+        _rpmMin = min(_rpmMin, rpmRounded);
+        _rpmMax = max(_rpmMax, rpmRounded);
+        _sparkMin = min(_sparkMin, sparkHalfDegrees);
+        _sparkMax = max(_sparkMax, sparkHalfDegrees);
+    }
+
+    if (_numFrames < UINT16_MAX) {
+        _numFrames++;
+        _rpmSum += rpmRounded;
+    }
+
+    uint8_t bin = constrain((int)(tps * ECU_STATS_TPS_BINS / 100.0f), 0, ECU_STATS_TPS_BINS - 1);
+    _tpsTime[bin] += dt;
+    if (tps >= ECU_STATS_WOT_TPS) {
+        _wotTime += dt;
+    }
+}
+
+void EcuStats::reset() {
+    _numFrames = 0;
+    _rpmSum = 0;
+    memset(_tpsTime, 0, sizeof(_tpsTime));
+    _wotTime = 0;
+}
+
+uint16_t EcuStats::getNumFrames() {
+    return _numFrames;
+}
+
+String EcuStats::toString() {
+    CompactEncoder encoder;
+    encoder.addUnsigned(_numFrames);
+    encoder.addUnsigned(_rpmMin);
+    encoder.addUnsigned(_rpmMax);
+    encoder.addUnsigned(_numFrames > 0 ? (_rpmSum + _numFrames / 2) / _numFrames : 0);
+    for (uint8_t i = 0; i < ECU_STATS_TPS_BINS; i++) {
+        encoder.addUnsigned(_tpsTime[i]);
+    }
+    encoder.addUnsigned(_wotTime);
+    encoder.addSigned(_sparkMin);
+    encoder.addSigned(_sparkMax);
+    return encoder.toBase64();
+}
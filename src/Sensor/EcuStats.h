@@ -0,0 +1,58 @@
+#ifndef _ECU_STATS_H_
+#define _ECU_STATS_H_
+
+#include "Particle.h"
+
+// Number of throttle position histogram bins over 0-100 %
+#define ECU_STATS_TPS_BINS      10
+// Throttle position counted as wide-open (%)
+#define ECU_STATS_WOT_TPS       90.0f
+
+/**
+ * @brief Constant-memory statistics of every ECU frame received during a logging interval
+ *
+ * RPM min/max/mean, throttle position histogram, time at wide-open throttle and spark advance range.
+ * Each frame is weighted by the time since the previous frame, so the histogram and wide-open time are in ms.
+ */
+class EcuStats {
+    public:
+        /**
+         * @brief Adds the values of a frame
+         *
+         * @param rpm engine speed
+         * @param tps throttle position (%)
+         * @param spark spark advance (CrA)
+         * @param dt time since the previous frame (ms), 0 for the first frame
+         */
+        void add(float rpm, float tps, float spark, uint32_t dt);
+
+        /**
+         * @brief Clears statistics for the next interval
+         */
+        void reset();
+
+        /**
+         * @return Number of frames added since reset
+         */
+        uint16_t getNumFrames();
+
+        /**
+         * @brief Statistics since reset written with CompactEncoder:
+         *
+         * number of frames, RPM min, max, mean, each TPS bin (ms, bin i covers i*10 to (i+1)*10 %),
+         * wide-open throttle time (ms) (all unsigned), then spark advance min and max * 2 (signed)
+         */
+        String toString();
+
+    private:
+        uint16_t _numFrames = 0;
+        uint16_t _rpmMin = 0;
+        uint16_t _rpmMax = 0;
+        uint32_t _rpmSum = 0;
+        uint32_t _tpsTime[ECU_STATS_TPS_BINS] = { };
+        uint32_t _wotTime = 0;
+        int16_t _sparkMin = 0;      // half degrees
+        int16_t _sparkMax = 0;
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "EnergyIntegrator.h"
+#include "settings.h"
+
+#define SECONDS_IN_HOUR         3600.0
+#define MICROSECONDS_IN_SECOND  1000000.0
+#define METERS_IN_KILOMETER     1000.0
+
+// Samples further apart than this (us) aren't integrated, e.g. while bms is asleep or being switched
+#define MAX_SAMPLE_GAP          1000000
+// Efficiency is only valid once this distance (m) has been travelled
+#define MIN_EFFICIENCY_DISTANCE 100.0
+
+EnergyIntegrator::EnergyIntegrator(SensorGps* gps) : _gps(gps) { }
+
+void EnergyIntegrator::begin() { }
+
+void EnergyIntegrator::handle() { }
+
+String EnergyIntegrator::getHumanName() {
+    return "EnergyIntegrator";
+}
+
+void EnergyIntegrator::addSample(float voltage, float current) {
+    uint32_t time = micros();
+    float power = voltage * current;
+
+    uint32_t elapsed = time - _lastSampleMicros;
+    if (_hasSample && elapsed < MAX_SAMPLE_GAP) {
+        double seconds = elapsed / MICROSECONDS_IN_SECOND;
+        _charge += (current + _lastCurrent) * 0.5 * seconds;
+        _energy += (power + _lastPower) * 0.5 * seconds;
+    }
+
+    _lastSampleMicros = time;
+    _lastCurrent = current;
+    _lastPower = power;
+    _hasSample = true;
+}
+
+void EnergyIntegrator::startLap() {
+    double distance = _gps->getOdometer();
+
+    _lapEnergy = (_energy - _lapStartEnergy) / SECONDS_IN_HOUR;
+    _lapDistance = distance - _lapStartDistance;
+    _lapValid = true;
+
+    _lapStartEnergy = _energy;
+    _lapStartDistance = distance;
+}
+
+String EnergyIntegrator::getCharge(bool& valid) {
+    valid = _hasSample;
+    return FLOAT_TO_STRING(_charge / SECONDS_IN_HOUR, 3);
+}
+
+String EnergyIntegrator::getEnergy(bool& valid) {
+    valid = _hasSample;
+    return FLOAT_TO_STRING(_energy / SECONDS_IN_HOUR, 2);
+}
+
+String EnergyIntegrator::getDistance(bool& valid) {
+    valid = true;
+    return FLOAT_TO_STRING(_gps->getOdometer() / METERS_IN_KILOMETER, 3);
+}
+
+String EnergyIntegrator::getEfficiency(bool& valid) {
+    double distance = _gps->getOdometer();
+    valid = _hasSample && distance >= MIN_EFFICIENCY_DISTANCE;
+    return FLOAT_TO_STRING(_efficiency(_energy, distance), 1);
+}
+
+float EnergyIntegrator::getWhPerKm() {
+    double distance = _gps->getOdometer();
+    return (_hasSample && distance >= MIN_EFFICIENCY_DISTANCE) ? _efficiency(_energy, distance) : 0.0f;
+}
+
+String EnergyIntegrator::getLapEnergy(bool& valid) {
+    valid = _lapValid;
+    return FLOAT_TO_STRING(_lapEnergy, 2);
+}
+
+String EnergyIntegrator::getLapEfficiency(bool& valid) {
+    valid = _lapValid && _lapDistance >= MIN_EFFICIENCY_DISTANCE;
+    return FLOAT_TO_STRING(_efficiency(_lapEnergy * SECONDS_IN_HOUR, _lapDistance), 1);
+}
+
+float EnergyIntegrator::getCurrentLapEnergy() {
+    return (_energy - _lapStartEnergy) / SECONDS_IN_HOUR;
+}
+
+float EnergyIntegrator::_efficiency(double energy, double distance) {
+    if (distance <= 0.0) {
+        return 0.0f;
+    }
+    return (energy / SECONDS_IN_HOUR) / (distance / METERS_IN_KILOMETER);
+}
@@ -0,0 +1,107 @@
+#ifndef _ENERGY_INTEGRATOR_H_
+#define _ENERGY_INTEGRATOR_H_
+
+#include "Sensor.h"
+#include "SensorGps.h"
+
+/**
+ * @brief Accumulates battery charge (Ah) and energy (Wh) from every bms current update and combines them
+ * with gps distance into efficiency (Wh/km), in total and per lap
+ *
+ * @note feed with addSample() from the bms power callback (see CanSensorBms::setPowerCallback)
+ */
+class EnergyIntegrator : public Sensor {
+    public:
+        /**
+         * Constructor
+         *
+         * @param gps gps sensor whose odometer is used for distance
+         */
+        EnergyIntegrator(SensorGps* gps);
+
+        void begin() override;
+
+        void handle() override;
+
+        String getHumanName() override;
+
+        /**
+         * @brief Integrates power since the previous sample (trapezoidal rule)
+         *
+         * @param voltage battery voltage (V)
+         * @param current battery current (A), positive when discharging
+         */
+        void addSample(float voltage, float current);
+
+        /**
+         * @brief Ends current lap: lap totals are available from the getLap methods until the next call
+         */
+        void startLap();
+
+        /**
+         * @return Charge drawn from battery since startup (Ah)
+         */
+        String getCharge(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Energy drawn from battery since startup (Wh)
+         */
+        String getEnergy(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Distance travelled since startup (km)
+         */
+        String getDistance(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Energy per distance since startup (Wh/km)
+         */
+        String getEfficiency(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Energy per distance since startup (Wh/km), 0 until enough distance has been travelled
+         */
+        float getWhPerKm();
+
+        /**
+         * @return Energy drawn during last completed lap (Wh)
+         */
+        String getLapEnergy(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Energy per distance of last completed lap (Wh/km)
+         */
+        String getLapEfficiency(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Energy drawn since current lap started (Wh)
+         */
+        float getCurrentLapEnergy();
+
+    private:
+        SensorGps* _gps;
+
+        // Totals (A·s and J to keep resolution of 50 ms samples)
+        double _charge = 0.0;
+        double _energy = 0.0;
+
+        // Previous sample
+        uint32_t _lastSampleMicros = 0;
+        float _lastCurrent = 0.0f;
+        float _lastPower = 0.0f;
+        bool _hasSample = false;
+
+        // Laps
+        double _lapStartEnergy = 0.0;
+        double _lapStartDistance = 0.0;
+        float _lapEnergy = 0.0f;
+        float _lapDistance = 0.0f;
+        bool _lapValid = false;
+
+        /**
+         * @return efficiency (Wh/km) of energy (J) over distance (m)
+         */
+        static float _efficiency(double energy, double distance);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "FuelIntegrator.h"
+#include "settings.h"
+
+#define MICROSECONDS_IN_SECOND  1000000.0
+#define MILLISECONDS_IN_MINUTE  60000.0f
+#define SECONDS_IN_MINUTE       60.0f
+
+// Four-stroke engine, each injector fires once per cycle (two revolutions)
+#define INJECTIONS_PER_REVOLUTION   0.5f
+// Samples further apart than this (us) aren't integrated, e.g. while ecu is off
+#define MAX_SAMPLE_GAP          1000000
+// Economy is only valid once this distance (m) has been travelled and fuel (mL) used
+#define MIN_ECONOMY_DISTANCE    100.0
+#define MIN_ECONOMY_FUEL        1.0
+
+FuelIntegrator::FuelIntegrator(SensorGps* gps, float injectorFlow, float injectorDeadTime)
+    : _gps(gps), _injectorFlow(injectorFlow / MILLISECONDS_IN_MINUTE), _injectorDeadTime(injectorDeadTime) { }
+
+void FuelIntegrator::begin() { }
+
+void FuelIntegrator::handle() { }
+
+String FuelIntegrator::getHumanName() {
+    return "FuelIntegrator";
+}
+
+void FuelIntegrator::addSample(float rpm, float fuelPW1, float fuelPW2) {
+    uint32_t time = micros();
+    float flow = _flow(rpm, fuelPW1, fuelPW2);
+
+    uint32_t elapsed = time - _lastSampleMicros;
+    if (_hasSample && elapsed < MAX_SAMPLE_GAP) {
+        _fuel += (flow + _lastFlow) * 0.5 * (elapsed / MICROSECONDS_IN_SECOND);
+    }
+
+    _lastSampleMicros = time;
+    _lastFlow = flow;
+    _hasSample = true;
+}
+
+void FuelIntegrator::startLap() {
+    double distance = _gps->getOdometer();
+
+    _lapFuel = _fuel - _lapStartFuel;
+    _lapDistance = distance - _lapStartDistance;
+    _lapValid = true;
+
+    _lapStartFuel = _fuel;
+    _lapStartDistance = distance;
+}
+
+String FuelIntegrator::getFlow(bool& valid) {
+    valid = _hasSample && micros() - _lastSampleMicros < MAX_SAMPLE_GAP;
+    return FLOAT_TO_STRING(_lastFlow * SECONDS_IN_MINUTE, 1);
+}
+
+String FuelIntegrator::getFuel(bool& valid) {
+    valid = _hasSample;
+    return FLOAT_TO_STRING(_fuel, 1);
+}
+
+String FuelIntegrator::getEconomy(bool& valid) {
+    double distance = _gps->getOdometer();
+    valid = _hasSample && distance >= MIN_ECONOMY_DISTANCE && _fuel >= MIN_ECONOMY_FUEL;
+    return FLOAT_TO_STRING(_economy(distance, _fuel), 1);
+}
+
+String FuelIntegrator::getLapFuel(bool& valid) {
+    valid = _lapValid;
+    return FLOAT_TO_STRING(_lapFuel, 1);
+}
+
+String FuelIntegrator::getLapEconomy(bool& valid) {
+    valid = _lapValid && _lapDistance >= MIN_ECONOMY_DISTANCE && _lapFuel >= MIN_ECONOMY_FUEL;
+    return FLOAT_TO_STRING(_economy(_lapDistance, _lapFuel), 1);
+}
+
+float FuelIntegrator::getCurrentLapFuel() {
+    return _fuel - _lapStartFuel;
+}
+
+float FuelIntegrator::_flow(float rpm, float fuelPW1, float fuelPW2) {
+    float openTime = max(fuelPW1 - _injectorDeadTime, 0.0f) + max(fuelPW2 - _injectorDeadTime, 0.0f);
+    float injectionsPerSecond = rpm * INJECTIONS_PER_REVOLUTION / SECONDS_IN_MINUTE;
+    return openTime * _injectorFlow * injectionsPerSecond;
+}
+
+float FuelIntegrator::_economy(double distance, double fuel) {
+    if (fuel <= 0.0) {
+        return 0.0f;
+    }
+    // m/mL = km/L
+    return distance / fuel;
+}
@@ -0,0 +1,104 @@
+#ifndef _FUEL_INTEGRATOR_H_
+#define _FUEL_INTEGRATOR_H_
+
+#include "Sensor.h"
+#include "SensorGps.h"
+
+/**
+ * @brief Computes fuel flow from injector pulse widths and engine speed of every ecu frame, accumulates fuel used
+ * and combines it with gps distance into fuel economy (km/L), in total and per lap
+ *
+ * @note feed with addSample() from the ecu fuel callback (see SensorEcu::setFuelCallback)
+ */
+class FuelIntegrator : public Sensor {
+    public:
+        /**
+         * Constructor
+         *
+         * @param gps gps sensor whose odometer is used for distance
+         * @param injectorFlow static flow of each injector (cc/min)
+         * @param injectorDeadTime opening time of injector during which no fuel flows (ms)
+         */
+        FuelIntegrator(SensorGps* gps, float injectorFlow, float injectorDeadTime);
+
+        void begin() override;
+
+        void handle() override;
+
+        String getHumanName() override;
+
+        /**
+         * @brief Integrates fuel flow since the previous sample (trapezoidal rule)
+         *
+         * @param rpm engine speed
+         * @param fuelPW1 injector 1 pulse width (ms)
+         * @param fuelPW2 injector 2 pulse width (ms)
+         */
+        void addSample(float rpm, float fuelPW1, float fuelPW2);
+
+        /**
+         * @brief Ends current lap: lap totals are available from the getLap methods until the next call
+         */
+        void startLap();
+
+        /**
+         * @return Fuel flow of last sample (mL/min)
+         */
+        String getFlow(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Fuel used since startup (mL)
+         */
+        String getFuel(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Distance per fuel since startup (km/L)
+         */
+        String getEconomy(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Fuel used during last completed lap (mL)
+         */
+        String getLapFuel(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Distance per fuel of last completed lap (km/L)
+         */
+        String getLapEconomy(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Fuel used since current lap started (mL)
+         */
+        float getCurrentLapFuel();
+
+    private:
+        SensorGps* _gps;
+        float _injectorFlow;        // mL/ms
+        float _injectorDeadTime;
+
+        double _fuel = 0.0;         // mL
+
+        // Previous sample
+        uint32_t _lastSampleMicros = 0;
+        float _lastFlow = 0.0f;     // mL/s
+        bool _hasSample = false;
+
+        // Laps
+        double _lapStartFuel = 0.0;
+        double _lapStartDistance = 0.0;
+        float _lapFuel = 0.0f;
+        float _lapDistance = 0.0f;
+        bool _lapValid = false;
+
+        /**
+         * @return fuel flow (mL/s) of both injectors
+         */
+        float _flow(float rpm, float fuelPW1, float fuelPW2);
+
+        /**
+         * @return economy (km/L) of distance (m) over fuel (mL)
+         */
+        static float _economy(double distance, double fuel);
+};
+
+#endif
@@ -0,0 +1,229 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "GeoFence.h"
+#include "settings.h"
+#include "gpsGreenlist.h"
+
+#define GEOFENCE_FILE           "/usr/geofence.txt"
+#define GEOFENCE_TEMP_FILE      "/usr/geofence.tmp"
+// Longest zone file read on load (bytes)
+#define GEOFENCE_FILE_MAX_SIZE  16384
+#define TEN_POWER_SEVEN         10000000.0
+
+GeoFence::GeoFence() {
+    _loadDefaults();
+}
+
+void GeoFence::load() {
+    // defaults are only kept if no zones were ever saved: an empty file is a cleared fence
+    int file = open(GEOFENCE_FILE, O_RDONLY);
+    if (file < 0) {
+        return;
+    }
+
+    int size = lseek(file, 0, SEEK_END);
+    lseek(file, 0, SEEK_SET);
+    if (size > GEOFENCE_FILE_MAX_SIZE) {
+        DEBUG_SERIAL_LN("ERROR: GEOFENCE FILE TOO LARGE");
+        close(file);
+        return;
+    }
+
+    _numZones = 0;
+    _numVertices = 0;
+    _cacheValid = false;
+
+    if (size <= 0) {
+        close(file);
+        DEBUG_SERIAL_LN("Geofence: loaded 0 zones");
+        return;
+    }
+
+    char* buffer = new char[size + 1];
+    int length = read(file, buffer, size);
+    close(file);
+    buffer[length > 0 ? length : 0] = '\0';
+
+    char* save;
+    for (char* line = strtok_r(buffer, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        if (!_addZone(line)) {
+            DEBUG_SERIAL_LN("ERROR: GEOFENCE ZONE INVALID: " + String(line));
+        }
+    }
+    delete[] buffer;
+
+    DEBUG_SERIAL_LN("Geofence: loaded " + String(_numZones) + " zones");
+}
+
+bool GeoFence::contains(int32_t latitude, int32_t longitude) {
+    if (_cacheValid && latitude == _lastLatitude && longitude == _lastLongitude) {
+        return _lastResult;
+    }
+    _lastLatitude = latitude;
+    _lastLongitude = longitude;
+    _cacheValid = true;
+
+    // zone which contained the last position first, then the rest
+    if (_lastZone < _numZones && _zoneContains(_zones[_lastZone], latitude, longitude)) {
+        _lastResult = true;
+        return true;
+    }
+
+    for (uint8_t i = 0; i < _numZones; i++) {
+        if (i != _lastZone && _zoneContains(_zones[i], latitude, longitude)) {
+            _lastZone = i;
+            _lastResult = true;
+            return true;
+        }
+    }
+
+    _lastResult = false;
+    return false;
+}
+
+int GeoFence::command(String command) {
+    command.trim();
+    _cacheValid = false;
+
+    if (command.startsWith("add ")) {
+        if (!_addZone(command.substring(4).c_str())) {
+            return -1;
+        }
+    } else if (command.equalsIgnoreCase("clear")) {
+        _numZones = 0;
+        _numVertices = 0;
+    } else if (command.equalsIgnoreCase("default")) {
+        _loadDefaults();
+    } else if (command.equalsIgnoreCase("save")) {
+        if (!_save()) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+
+    return _numZones;
+}
+
+uint8_t GeoFence::getNumZones() {
+    return _numZones;
+}
+
+void GeoFence::_loadDefaults() {
+    _numZones = 0;
+    _numVertices = 0;
+    _cacheValid = false;
+
+    for (const positionBox& box : GREEN_LIST) {
+        if (_numVertices + 4 > GEOFENCE_MAX_VERTICES) {
+            break;
+        }
+        uint16_t first = _numVertices;
+        const double corners[4][2] = { {box.northLat, box.westLon}, {box.northLat, box.eastLon},
+                                       {box.southLat, box.eastLon}, {box.southLat, box.westLon} };
+        for (uint8_t i = 0; i < 4; i++) {
+            _latitudes[_numVertices] = (int32_t)lround(corners[i][0] * TEN_POWER_SEVEN);
+            _longitudes[_numVertices] = (int32_t)lround(corners[i][1] * TEN_POWER_SEVEN);
+            _numVertices++;
+        }
+        _closeZone(first);
+    }
+}
+
+bool GeoFence::_addZone(const char* text) {
+    uint16_t first = _numVertices;
+    const char* position = text;
+
+    while (*position != '\0' && *position != '\r') {
+        char* end;
+        double latitude = strtod(position, &end);
+        if (end == position || *end != ',') {
+            _numVertices = first;
+            return false;
+        }
+        position = end + 1;
+
+        double longitude = strtod(position, &end);
+        if (end == position || latitude < -90.0 || latitude > 90.0 || longitude < -180.0 || longitude > 180.0
+            || _numVertices >= GEOFENCE_MAX_VERTICES) {
+            _numVertices = first;
+            return false;
+        }
+        position = *end == ';' ? end + 1 : end;
+
+        _latitudes[_numVertices] = (int32_t)lround(latitude * TEN_POWER_SEVEN);
+        _longitudes[_numVertices] = (int32_t)lround(longitude * TEN_POWER_SEVEN);
+        _numVertices++;
+    }
+
+    if (!_closeZone(first)) {
+        _numVertices = first;
+        return false;
+    }
+    return true;
+}
+
+bool GeoFence::_closeZone(uint16_t firstVertex) {
+    uint16_t numVertices = _numVertices - firstVertex;
+    if (numVertices < 3 || _numZones >= GEOFENCE_MAX_ZONES) {
+        return false;
+    }
+
+    Zone& zone = _zones[_numZones++];
+    zone.firstVertex = firstVertex;
+    zone.numVertices = numVertices;
+    zone.minLatitude = zone.maxLatitude = _latitudes[firstVertex];
+    zone.minLongitude = zone.maxLongitude = _longitudes[firstVertex];
+    for (uint16_t i = firstVertex + 1; i < _numVertices; i++) {
+        zone.minLatitude = min(zone.minLatitude, _latitudes[i]);
+        zone.maxLatitude = max(zone.maxLatitude, _latitudes[i]);
+        zone.minLongitude = min(zone.minLongitude, _longitudes[i]);
+        zone.maxLongitude = max(zone.maxLongitude, _longitudes[i]);
+    }
+    return true;
+}
+
+bool GeoFence::_zoneContains(const Zone& zone, int32_t latitude, int32_t longitude) {
+    if (latitude < zone.minLatitude || latitude > zone.maxLatitude
+        || longitude < zone.minLongitude || longitude > zone.maxLongitude) {
+        return false;
+    }
+
+    // ray casting towards +longitude: inside if an odd number of edges are crossed
+    bool inside = false;
+    uint16_t last = zone.firstVertex + zone.numVertices - 1;
+    for (uint16_t i = zone.firstVertex, j = last; i <= last; j = i++) {
+        if ((_latitudes[i] > latitude) != (_latitudes[j] > latitude)) {
+            double crossing = _longitudes[i] + (double)(_longitudes[j] - _longitudes[i])
+                * (latitude - _latitudes[i]) / (_latitudes[j] - _latitudes[i]);
+            if (longitude < crossing) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+bool GeoFence::_save() {
+    int file = open(GEOFENCE_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC);
+    if (file < 0) {
+        return false;
+    }
+
+    bool written = true;
+    char vertex[32];
+    for (uint8_t i = 0; i < _numZones && written; i++) {
+        const Zone& zone = _zones[i];
+        for (uint16_t v = zone.firstVertex; v < zone.firstVertex + zone.numVertices && written; v++) {
+            bool lastVertex = v == zone.firstVertex + zone.numVertices - 1;
+            int length = snprintf(vertex, sizeof(vertex), "%.7f,%.7f%c", _latitudes[v] / TEN_POWER_SEVEN,
+                _longitudes[v] / TEN_POWER_SEVEN, lastVertex ? '\n' : ';');
+            written = write(file, vertex, length) == length;
+        }
+    }
+    close(file);
+
+    // write then rename so a reset mid-write keeps the previous zones
+    return written && rename(GEOFENCE_TEMP_FILE, GEOFENCE_FILE) == 0;
+}
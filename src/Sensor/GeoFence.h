@@ -0,0 +1,101 @@
+#ifndef _GEO_FENCE_H_
+#define _GEO_FENCE_H_
+
+#include "Particle.h"
+
+// Zone and vertex pool sizes (vertices are shared by all zones)
+#define GEOFENCE_MAX_ZONES      48
+#define GEOFENCE_MAX_VERTICES   512
+
+/**
+ * @brief Set of polygon zones where gps position may be uploaded (replaces the hard-coded greenlist boxes)
+ *
+ * Zones are loaded from a file on flash, or the GREEN_LIST boxes if there is none, and can be changed at runtime
+ * with command(). Each zone keeps its bounding box so most zones are rejected with four comparisons, and the
+ * zone which last contained the position is checked first, so a lookup is O(1) while the vehicle stays in a venue.
+ *
+ * Zone format (file line or "add" command): lat,lon;lat,lon;lat,lon[;...] in degrees, at least 3 vertices
+ */
+class GeoFence {
+    public:
+        GeoFence();
+
+        /**
+         * @brief Loads zones from file (an empty file has no zones), or GREEN_LIST boxes if the file doesn't exist
+         */
+        void load();
+
+        /**
+         * @param latitude degrees * 1e-7
+         * @param longitude degrees * 1e-7
+         * @return true if position is inside any zone
+         */
+        bool contains(int32_t latitude, int32_t longitude);
+
+        /**
+         * @brief Runs a zone command:
+         *
+         * "add <zone>" adds a zone, "clear" removes all zones, "default" restores GREEN_LIST boxes,
+         * "save" writes zones to file so they are loaded on next boot
+         *
+         * @return number of zones, or -1 if command failed
+         */
+        int command(String command);
+
+        /**
+         * @return number of zones
+         */
+        uint8_t getNumZones();
+
+    private:
+        struct Zone {
+            int32_t minLatitude;
+            int32_t maxLatitude;
+            int32_t minLongitude;
+            int32_t maxLongitude;
+            uint16_t firstVertex;
+            uint16_t numVertices;
+        };
+
+        Zone _zones[GEOFENCE_MAX_ZONES];
+        uint8_t _numZones = 0;
+        int32_t _latitudes[GEOFENCE_MAX_VERTICES];
+        int32_t _longitudes[GEOFENCE_MAX_VERTICES];
+        uint16_t _numVertices = 0;
+
+        // result cache
+        uint8_t _lastZone = 0;
+        int32_t _lastLatitude = 0;
+        int32_t _lastLongitude = 0;
+        bool _lastResult = false;
+        bool _cacheValid = false;
+
+        /**
+         * @brief Replaces zones with GREEN_LIST boxes
+         */
+        void _loadDefaults();
+
+        /**
+         * @brief Parses and adds a zone
+         *
+         * @return false if zone is malformed or doesn't fit
+         */
+        bool _addZone(const char* text);
+
+        /**
+         * @brief Adds zone from vertices already appended to the pool at firstVertex
+         */
+        bool _closeZone(uint16_t firstVertex);
+
+        /**
+         * @return true if position is inside zone (bounding box, then ray casting)
+         */
+        bool _zoneContains(const Zone& zone, int32_t latitude, int32_t longitude);
+
+        /**
+         * @brief Writes zones to file
+         */
+        bool _save();
+};
+
+#endif
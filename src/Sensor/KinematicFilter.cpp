@@ -0,0 +1,119 @@
+#include "KinematicFilter.h"
+
+// Initial variance of the unmeasured derivatives
+#define INITIAL_DERIVATIVE_VARIANCE 100.0f
+// Lower bound on measurement standard deviation, receivers report optimistic accuracy at rest
+#define MIN_ACCURACY                0.05f
+// Gaps longer than this (s) restart the filter
+#define MAX_DT                      2.0f
+
+KinematicFilter::KinematicFilter(uint8_t numStates, float processNoise)
+    : _numStates(constrain(numStates, (uint8_t)2, (uint8_t)KINEMATIC_FILTER_MAX_STATES)),
+      _processVariance(processNoise * processNoise) {
+    reset();
+}
+
+void KinematicFilter::update(float value, float accuracy, float dt) {
+    float accuracyBounded = max(accuracy, MIN_ACCURACY);
+    float variance = accuracyBounded * accuracyBounded;
+
+    if (!_initialized || dt <= 0.0f || dt > MAX_DT) {
+        _initialize(value, variance);
+        return;
+    }
+
+    _predict(dt);
+
+    // measurement of state 0: K = P[:,0] / (P00 + R)
+    float innovation = value - _x[0];
+    float s = _p[0][0] + variance;
+    float k[KINEMATIC_FILTER_MAX_STATES];
+    for (uint8_t i = 0; i < _numStates; i++) {
+        k[i] = _p[i][0] / s;
+        _x[i] += k[i] * innovation;
+    }
+
+    // P = P - K P[0,:]
+    float row[KINEMATIC_FILTER_MAX_STATES];
+    for (uint8_t j = 0; j < _numStates; j++) {
+        row[j] = _p[0][j];
+    }
+    for (uint8_t i = 0; i < _numStates; i++) {
+        for (uint8_t j = 0; j < _numStates; j++) {
+            _p[i][j] -= k[i] * row[j];
+        }
+    }
+}
+
+void KinematicFilter::reset() {
+    _initialized = false;
+    memset(_x, 0, sizeof(_x));
+    memset(_p, 0, sizeof(_p));
+}
+
+float KinematicFilter::getValue() {
+    return _x[0];
+}
+
+float KinematicFilter::getRate() {
+    return _x[1];
+}
+
+float KinematicFilter::getAcceleration() {
+    return _numStates > 2 ? _x[2] : 0.0f;
+}
+
+bool KinematicFilter::isInitialized() {
+    return _initialized;
+}
+
+void KinematicFilter::_predict(float dt) {
+    // F: f[i][j] = dt^(j-i) / (j-i)!
+    float f[KINEMATIC_FILTER_MAX_STATES] = { 1.0f, dt, dt * dt * 0.5f };
+
+    float x[KINEMATIC_FILTER_MAX_STATES];
+    for (uint8_t i = 0; i < _numStates; i++) {
+        x[i] = 0.0f;
+        for (uint8_t j = i; j < _numStates; j++) {
+            x[i] += f[j - i] * _x[j];
+        }
+    }
+    memcpy(_x, x, sizeof(x));
+
+    // F P
+    float fp[KINEMATIC_FILTER_MAX_STATES][KINEMATIC_FILTER_MAX_STATES];
+    for (uint8_t i = 0; i < _numStates; i++) {
+        for (uint8_t j = 0; j < _numStates; j++) {
+            fp[i][j] = 0.0f;
+            for (uint8_t m = i; m < _numStates; m++) {
+                fp[i][j] += f[m - i] * _p[m][j];
+            }
+        }
+    }
+
+    // (F P) F' + Q, highest derivative changes by a random step: G = [dt^(n-1)/(n-1)! ... dt, 1] * sqrt(q dt)
+    float g[KINEMATIC_FILTER_MAX_STATES];
+    for (uint8_t i = 0; i < _numStates; i++) {
+        g[i] = f[_numStates - 1 - i];
+    }
+    float q = _processVariance * dt;
+    for (uint8_t i = 0; i < _numStates; i++) {
+        for (uint8_t j = 0; j < _numStates; j++) {
+            float value = 0.0f;
+            for (uint8_t m = j; m < _numStates; m++) {
+                value += fp[i][m] * f[m - j];
+            }
+            _p[i][j] = value + g[i] * g[j] * q;
+        }
+    }
+}
+
+void KinematicFilter::_initialize(float value, float variance) {
+    reset();
+    _x[0] = value;
+    _p[0][0] = variance;
+    for (uint8_t i = 1; i < _numStates; i++) {
+        _p[i][i] = INITIAL_DERIVATIVE_VARIANCE;
+    }
+    _initialized = true;
+}
@@ -0,0 +1,84 @@
+#ifndef _KINEMATIC_FILTER_H_
+#define _KINEMATIC_FILTER_H_
+
+#include "Particle.h"
+
+// Maximum number of states (value and its derivatives)
+#define KINEMATIC_FILTER_MAX_STATES 3
+
+// Process noise of SensorGps filters: expected change of horizontal acceleration (m/s^2 per s) and of vertical
+// acceleration (m/s^2 per s), higher follows faster changes with more noise (tuned with test/KinematicFilterTest.cpp)
+#define GPS_HORIZONTAL_PROCESS_NOISE    1.0f
+#define GPS_VERTICAL_PROCESS_NOISE      0.1f
+
+/**
+ * @brief Fixed-cost Kalman filter estimating a measured value and its derivatives
+ *
+ * Constant-derivative model: with 3 states (value, rate, acceleration) the acceleration is modelled as a random
+ * walk driven by processNoise, with 2 states (value, rate) the rate is. Only the value is measured, with a
+ * variance given per sample (ie. from the receiver's accuracy estimate), so derivatives are estimated without
+ * finite differences of noisy samples.
+ */
+class KinematicFilter {
+    public:
+        /**
+         * Constructor
+         *
+         * @param numStates 2 (value, rate) or 3 (value, rate, acceleration)
+         * @param processNoise standard deviation of the change of the highest derivative per second
+         */
+        KinematicFilter(uint8_t numStates, float processNoise);
+
+        /**
+         * @brief Predicts state dt seconds ahead then corrects it with a measurement
+         *
+         * @param value measured value
+         * @param accuracy standard deviation of the measurement
+         * @param dt time since previous measurement (s), filter restarts from the measurement if not positive
+         */
+        void update(float value, float accuracy, float dt);
+
+        /**
+         * @brief Filter restarts from the next measurement
+         */
+        void reset();
+
+        /**
+         * @return estimated value
+         */
+        float getValue();
+
+        /**
+         * @return estimated first derivative (value per second)
+         */
+        float getRate();
+
+        /**
+         * @return estimated second derivative (value per second^2), 0 with 2 states
+         */
+        float getAcceleration();
+
+        /**
+         * @return true once a measurement has been added
+         */
+        bool isInitialized();
+
+    private:
+        uint8_t _numStates;
+        float _processVariance;
+        float _x[KINEMATIC_FILTER_MAX_STATES];
+        float _p[KINEMATIC_FILTER_MAX_STATES][KINEMATIC_FILTER_MAX_STATES];
+        bool _initialized = false;
+
+        /**
+         * @brief x = F x, P = F P F' + Q
+         */
+        void _predict(float dt);
+
+        /**
+         * @brief Starts from a measurement with unknown derivatives
+         */
+        void _initialize(float value, float variance);
+};
+
+#endif
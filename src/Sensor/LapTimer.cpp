@@ -0,0 +1,157 @@
+#include <cmath>
+
+#include "LapTimer.h"
+#include "settings.h"
+
+#define MILLISECONDS_IN_SECOND  1000
+#define NANOSECONDS_IN_MILLISECOND 1000000
+#define TEN_POWER_SEVEN         10000000.0
+
+// Metres per 1e-7 degree of latitude (and of longitude at the equator)
+#define METERS_PER_UNIT         0.011132f
+// A gate crossed again within this time (ms) is ignored (gps jitter on the line, slow crossings)
+#define GATE_MIN_INTERVAL_MS    10000
+// Fixes further apart than this (ms) aren't joined into a segment
+#define MAX_FIX_GAP_MS          2000
+
+LapTimer::LapTimer(const timingGate* gates, uint8_t numGates) {
+    _numGates = min(numGates, (uint8_t)LAP_MAX_GATES);
+    for (uint8_t i = 0; i < _numGates; i++) {
+        Gate& gate = _gates[i];
+        gate.latitude1 = (int32_t)lround(gates[i].lat1 * TEN_POWER_SEVEN);
+        gate.longitude1 = (int32_t)lround(gates[i].lon1 * TEN_POWER_SEVEN);
+        gate.latitude2 = (int32_t)lround(gates[i].lat2 * TEN_POWER_SEVEN);
+        gate.longitude2 = (int32_t)lround(gates[i].lon2 * TEN_POWER_SEVEN);
+        gate.metersPerLongitude = METERS_PER_UNIT * cosf(gates[i].lat1 * (float)M_PI / 180.0f);
+        gate.lastCrossing = 0;
+    }
+}
+
+void LapTimer::begin() { }
+
+void LapTimer::handle() { }
+
+String LapTimer::getHumanName() {
+    return "LapTimer";
+}
+
+void LapTimer::addFix(const SensorGps::Pvt& pvt) {
+    if (!pvt.timeValid) {
+        return;
+    }
+
+    int64_t time = (int64_t)pvt.unixEpoch * MILLISECONDS_IN_SECOND + pvt.nanosecond / NANOSECONDS_IN_MILLISECOND;
+
+    if (_hasFix && time > _lastTime && time - _lastTime <= MAX_FIX_GAP_MS) {
+        for (uint8_t i = 0; i < _numGates; i++) {
+            float fraction = _crossing(_gates[i], pvt.latitude, pvt.longitude);
+            if (fraction >= 0.0f) {
+                _onCrossing(i, _lastTime + (int64_t)(fraction * (time - _lastTime)));
+            }
+        }
+    }
+
+    _lastLatitude = pvt.latitude;
+    _lastLongitude = pvt.longitude;
+    _lastTime = time;
+    _hasFix = true;
+}
+
+void LapTimer::setLapCallback(float (*lapBoundary)()) {
+    _lapCallback = lapBoundary;
+}
+
+String LapTimer::getLap(bool& valid) {
+    valid = _lapPending;
+    if (!valid) {
+        return "";
+    }
+    _lapPending = false;
+
+    CompactEncoder encoder;
+    encoder.addUnsigned(_lapNumber);
+    encoder.addUnsigned(_lapTime);
+    encoder.addUnsigned(_lapNumSectors);
+    for (uint8_t i = 0; i < _lapNumSectors; i++) {
+        encoder.addUnsigned(_lapSectorTimes[i]);
+    }
+    encoder.addSigned((int32_t)lroundf(_lapTotal * 100.0f));
+    return encoder.toBase64();
+}
+
+String LapTimer::getLastLapTime(bool& valid) {
+    valid = _lapNumber > 0;
+    return String(_lapTime / MILLISECONDS_IN_SECOND) + "." + String(_lapTime % MILLISECONDS_IN_SECOND + MILLISECONDS_IN_SECOND).substring(1);
+}
+
+int LapTimer::getLapNumber(bool& valid) {
+    valid = true;
+    return _lapNumber;
+}
+
+float LapTimer::_crossing(const Gate& gate, int32_t latitude, int32_t longitude) {
+    // local flat projection (m) relative to gate point 1
+    float px = (_lastLongitude - gate.longitude1) * gate.metersPerLongitude;
+    float py = (_lastLatitude - gate.latitude1) * METERS_PER_UNIT;
+    float dx = (longitude - _lastLongitude) * gate.metersPerLongitude;
+    float dy = (latitude - _lastLatitude) * METERS_PER_UNIT;
+    float ex = (gate.longitude2 - gate.longitude1) * gate.metersPerLongitude;
+    float ey = (gate.latitude2 - gate.latitude1) * METERS_PER_UNIT;
+
+    float denominator = dx * ey - dy * ex;
+    if (fabsf(denominator) < 1e-6f) {
+        // parallel to gate, or not moving
+        return -1.0f;
+    }
+
+    // previous fix + t * d = u * e
+    float t = (ex * py - ey * px) / denominator;
+    float u = (dx * py - dy * px) / denominator;
+
+    // a fix exactly on the line counts for the segment ending there, not the one starting there
+    if (t <= 0.0f || t > 1.0f || u < 0.0f || u > 1.0f) {
+        return -1.0f;
+    }
+    return t;
+}
+
+void LapTimer::_onCrossing(uint8_t gate, int64_t time) {
+    if (_gates[gate].lastCrossing != 0 && time - _gates[gate].lastCrossing < GATE_MIN_INTERVAL_MS) {
+        return;
+    }
+    _gates[gate].lastCrossing = time;
+
+    if (gate != 0) {
+        if (_lapStarted && gate == _nextGate) {
+            _sectorTimes[gate - 1] = time - _lastGateTime;
+            _lastGateTime = time;
+            _nextGate = (gate + 1) % _numGates;
+        } else {
+            // missed or out of order gate: no sector times this lap
+            _nextGate = LAP_MAX_GATES;
+        }
+        return;
+    }
+
+    float total = _lapCallback ? _lapCallback() : 0.0f;
+
+    if (_lapStarted) {
+        _lapNumber++;
+        _lapTime = time - _lapStartTime;
+        _lapNumSectors = 0;
+        if (_numGates > 1 && _nextGate == 0) {
+            _sectorTimes[_numGates - 1] = time - _lastGateTime;
+            _lapNumSectors = _numGates;
+            memcpy(_lapSectorTimes, _sectorTimes, sizeof(_sectorTimes));
+        }
+        _lapTotal = total;
+        _lapPending = true;
+
+        DEBUG_SERIAL_LN("Lap " + String(_lapNumber) + ": " + getLastLapTime() + "s");
+    }
+
+    _lapStarted = true;
+    _lapStartTime = time;
+    _lastGateTime = time;
+    _nextGate = _numGates > 1 ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+#ifndef _LAP_TIMER_H_
+#define _LAP_TIMER_H_
+
+#include "Sensor.h"
+#include "SensorGps.h"
+#include "CompactEncoder.h"
+#include "lapGates.h"
+
+// Maximum number of timing gates (start/finish + sector gates)
+#define LAP_MAX_GATES 8
+
+/**
+ * @brief Lap and sector timing from every gps fix
+ *
+ * Each pair of consecutive fixes is checked against every gate. The crossing time is interpolated along the
+ * segment between the fixes, so times are much finer than the fix interval. Gates crossed out of order
+ * invalidate that lap's sector times but not the lap time.
+ *
+ * @note feed with addFix() from the gps fix callback (see SensorGps::setFixCallback)
+ */
+class LapTimer : public Sensor {
+    public:
+        /**
+         * Constructor
+         *
+         * @param gates timing gates, start/finish first then sector gates in driving order
+         * @param numGates number of gates (at most LAP_MAX_GATES)
+         */
+        LapTimer(const timingGate* gates, uint8_t numGates);
+
+        void begin() override;
+
+        void handle() override;
+
+        String getHumanName() override;
+
+        /**
+         * @brief Checks segment from previous fix to this fix against every gate
+         */
+        void addFix(const SensorGps::Pvt& pvt);
+
+        /**
+         * @brief Update the callback function called at each start/finish crossing
+         *
+         * @param lapBoundary() returns the lap total (energy in Wh, fuel in mL...) since the previous call
+         */
+        void setLapCallback(float (*lapBoundary)());
+
+        /**
+         * @brief Last completed lap, once per lap (invalid until a new lap completes), written with CompactEncoder:
+         *
+         * lap number, lap time (ms), number of sectors (0 if sectors are invalid), each sector time (ms)
+         * (all unsigned), then lap total * 100 (signed)
+         */
+        String getLap(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Time of last completed lap (s)
+         */
+        String getLastLapTime(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Number of completed laps
+         */
+        int getLapNumber(bool& valid = Sensor::dummy);
+
+    private:
+        struct Gate {
+            int32_t latitude1;      // degrees * 1e-7
+            int32_t longitude1;
+            int32_t latitude2;
+            int32_t longitude2;
+            float metersPerLongitude;
+            int64_t lastCrossing;   // ms
+        };
+
+        Gate _gates[LAP_MAX_GATES];
+        uint8_t _numGates;
+        float (*_lapCallback)() = NULL;
+
+        // previous fix
+        int32_t _lastLatitude = 0;
+        int32_t _lastLongitude = 0;
+        int64_t _lastTime = 0;
+        bool _hasFix = false;
+
+        // current lap
+        bool _lapStarted = false;
+        int64_t _lapStartTime = 0;
+        int64_t _lastGateTime = 0;
+        uint8_t _nextGate = 0;
+        uint32_t _sectorTimes[LAP_MAX_GATES];
+
+        // last completed lap
+        uint16_t _lapNumber = 0;
+        uint32_t _lapTime = 0;
+        uint32_t _lapSectorTimes[LAP_MAX_GATES];
+        uint8_t _lapNumSectors = 0;
+        float _lapTotal = 0.0f;
+        bool _lapPending = false;
+
+        /**
+         * @brief Finds where segment from previous fix to (latitude, longitude) crosses gate
+         *
+         * @return fraction (0 - 1] of the segment at the crossing, negative if it doesn't cross
+         */
+        float _crossing(const Gate& gate, int32_t latitude, int32_t longitude);
+
+        /**
+         * @brief Updates lap and sector state for a gate crossing
+         *
+         * @param time crossing time (ms since epoch)
+         */
+        void _onCrossing(uint8_t gate, int64_t time);
+};
+
+#endif
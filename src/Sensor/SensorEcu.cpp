@@ -3,14 +3,6 @@
 
 #define ECU_BAUD                115200
 
-#define ECU_PACKET_SIZE         27
-
-#define ECU_HEADER_1            0x80
-#define ECU_HEADER_2            0x8F
-#define ECU_HEADER_3            0xEA
-#define ECU_DATA_FIELD_LENGTH   0x16
-#define ECU_SERVICE_ID          0x50
-
 SensorEcu::SensorEcu(USARTSerial *serial) {
     _serial = serial;
 }
@@ -19,6 +11,10 @@ String SensorEcu::getHumanName() {
     return "ECU";
 }
 
+void SensorEcu::setFuelCallback(void (*fuel)(float, float, float)) {
+    _fuelCallback = fuel;
+}
+
 void SensorEcu::begin() {
     _serial->begin(ECU_BAUD, SERIAL_8N1);
 }
@@ -28,6 +24,7 @@ void SensorEcu::flush() {
     {
         _serial->read();
     }
+    _parser.reset();
 }
 
 void SensorEcu::handle() {
@@ -37,106 +34,99 @@ void SensorEcu::handle() {
     } else {
         _valid = false;
     }
-    
-    if (_serial->available() < ECU_PACKET_SIZE) {
-        return;
+
+    // parse every received byte: the parser resynchronizes on the next header after a corrupted frame
+    while (_serial->available()) {
+        if (_parser.add(_serial->read())) {
+            _decodeFrame(_parser.getFrame());
+        }
     }
 
-    uint8_t buffer[27];
+}
 
-    _serial->readBytes((char *)buffer, ECU_PACKET_SIZE);
+String SensorEcu::getStats(bool &valid) {
+    valid = _stats.getNumFrames() > 0;
+    String stats = valid ? _stats.toString() : "";
+    _stats.reset();
+    return stats;
+}
 
-    uint8_t checkSum = 0;
-    for(int i = 0; i < 26; i++) {
-        checkSum += buffer[i];
-    }
+int SensorEcu::getGoodFrames(bool &valid) {
+    valid = true;
+    return _parser.getGoodFrames();
+}
 
-    // Check if the header is correct
-    if (buffer[0] == ECU_HEADER_1 && 
-        buffer[1] == ECU_HEADER_2 && 
-        buffer[2] == ECU_HEADER_3 && 
-        buffer[3] == ECU_DATA_FIELD_LENGTH && 
-        buffer[4] == ECU_SERVICE_ID) {
-
-            // Check if the checksum is correct
-            if(checkSum == buffer[26]){
-
-                _lastUpdate = millis();
-
-                // Data is valid, update all fields
-                _rpm = this->_interpretValue(buffer[6], buffer[7], 0.25, 0.0);
-                _map = this->_interpretValue(buffer[8], buffer[9], 0.0039, 0.0);
-                _tps = this->_interpretValue(buffer[10], buffer[11], 0.0015, 0.0);
-                _ect = this->_interpretValue(buffer[12], buffer[13], 1, -40.0);
-                _iat = this->_interpretValue(buffer[14], buffer[15], 1, -40.0);
-                _o2s = this->_interpretValue(buffer[16], buffer[17], 0.0048, 0.0);
-                _spark = this->_interpretValue(buffer[18], buffer[19], 0.5, 0.0);
-                _fuelPW1 = this->_interpretValue(buffer[20], buffer[21], 0.001, 0.0);
-                _fuelPW2 = this->_interpretValue(buffer[22], buffer[23], 0.001, 0.0);
-                _ubAdc = this->_interpretValue(buffer[24], buffer[25], 0.00625, 0.0);
-
-            } else {
-                DEBUG_SERIAL_LN("ERROR: ECU Packet Checksum Invalid");
-            }
-
-    }else{
-        // The header is not correct, flush the serial buffer
-        flush();
-    }
+int SensorEcu::getBadFrames(bool &valid) {
+    valid = true;
+    return _parser.getBadFrames();
+}
+
+void SensorEcu::_decodeFrame(const uint8_t* buffer) {
+    uint32_t now = millis();
+    // gaps longer than a stale interval are not attributed to the throttle position of either frame
+    uint32_t dt = (_lastUpdate > 0 && now - _lastUpdate < STALE_INTERVAL) ? now - _lastUpdate : 0;
+    _lastUpdate = now;
 
+    decodeEcuFields(buffer, _values);
+
+    _stats.add(_values[Rpm], _values[Tps], _values[Spark], dt);
+    if (_fuelCallback) {
+        _fuelCallback(_values[Rpm], _values[FuelPW1], _values[FuelPW2]);
+    }
 }
 
 int SensorEcu::getRPM(bool &valid) {
-    valid = _valid;
-    return this->_rpm;
+    return getFieldInt(Rpm, valid);
 }
 
 String SensorEcu::getMap(bool &valid) {
-    valid = _valid;
-    return FLOAT_TO_STRING(this->_map, 2);
+    return getFieldString(Map, valid);
 }
 
 int SensorEcu::getTPS(bool &valid) {
-    valid = _valid;
-    return this->_tps;
+    return getFieldInt(Tps, valid);
 }
 
 int SensorEcu::getECT(bool &valid) {
-    valid = _valid;
-    return this->_ect;
+    return getFieldInt(Ect, valid);
 }
 
 int SensorEcu::getIAT(bool &valid) {
-    valid = _valid;
-    return this->_iat;
+    return getFieldInt(Iat, valid);
 }
 
 String SensorEcu::getO2S(bool &valid) {
-    valid = _valid;
-    return FLOAT_TO_STRING(this->_o2s, 2);
+    return getFieldString(O2s, valid);
 }
 
 int SensorEcu::getSpark(bool &valid) {
-    valid = _valid;
-    return this->_spark;
+    return getFieldInt(Spark, valid);
 }
 
 String SensorEcu::getFuelPW1(bool &valid) {
-    valid = _valid;
-    return FLOAT_TO_STRING(this->_fuelPW1, 3);
+    return getFieldString(FuelPW1, valid);
 }
 
 String SensorEcu::getFuelPW2(bool &valid) {
-    valid = _valid;
-    return FLOAT_TO_STRING(this->_fuelPW2, 3);
+    return getFieldString(FuelPW2, valid);
 }
 
 String SensorEcu::getUbAdc(bool &valid) {
+    return getFieldString(UbAdc, valid);
+}
+
+float SensorEcu::getValue(FieldId field, bool &valid) {
     valid = _valid;
-    return FLOAT_TO_STRING(this->_ubAdc, 1);
+    return _values[field];
 }
 
-float SensorEcu::_interpretValue(uint8_t high, uint8_t low, float factor, float offset) {
-    return (float)((int)high * 256 + (int)low) * factor + offset;
+String SensorEcu::getFieldString(uint8_t index, bool &valid) {
+    valid = _valid;
+    return FLOAT_TO_STRING(_values[index], ECU_FIELDS[index].decimals);
+}
+
+int SensorEcu::getFieldInt(uint8_t index, bool &valid) {
+    valid = _valid;
+    return (int)_values[index];
 }
 
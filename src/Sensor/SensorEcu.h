@@ -2,9 +2,18 @@
 #define _SENSOR_ECU_H_
 
 #include "Sensor.h"
+#include "EcuFrameParser.h"
+#include "EcuFields.h"
+#include "EcuStats.h"
 
 class SensorEcu : public Sensor {
     public:
+        /**
+         * Index of each field in ECU_FIELDS
+         **/
+        enum FieldId { Rpm, Map, Tps, Ect, Iat, O2s, Spark, FuelPW1, FuelPW2, UbAdc, NUM_FIELD_IDS };
+        static_assert(NUM_FIELD_IDS == ECU_NUM_FIELDS, "FieldId doesn't match ECU_FIELDS");
+
         /**
          * Constructor 
          * @param *serial bus receiving ECU data
@@ -22,12 +31,19 @@ class SensorEcu : public Sensor {
         void flush();
 
         /**
-         * Checks Serial buffer for incoming data. If a full ECU data frame is in buffer, parses and saves it
+         * Parses all received bytes, saving each valid ECU data frame
          * */
         void handle() override;
 
         String getHumanName() override;
 
+        /**
+         * @brief Set the callback function notified of every valid frame
+         *
+         * @param fuel() Pointer to function to call with engine speed (RPM) and injector 1 and 2 pulse widths (ms)
+         * */
+        void setFuelCallback(void (*fuel)(float, float, float));
+
         /**
          * @return Engine Speed, RPM
          * */
@@ -78,32 +94,52 @@ class SensorEcu : public Sensor {
         * */
         String getUbAdc(bool &valid = Sensor::dummy);
 
+        /**
+        * @return Decoded value of field (see ECU_FIELDS)
+        * */
+        float getValue(FieldId field, bool &valid = Sensor::dummy);
+
+        /**
+        * @return Field as a string with the field's decimals (for EcuField::Fixed logging commands)
+        * */
+        String getFieldString(uint8_t index, bool &valid);
+
+        /**
+        * @return Field truncated to int (for EcuField::Int logging commands)
+        * */
+        int getFieldInt(uint8_t index, bool &valid);
+
+        /**
+        * @brief Statistics of every frame since the previous call (see EcuStats::toString), invalid if no frames
+        * were received
+        * */
+        String getStats(bool &valid = Sensor::dummy);
+
+        /**
+        * @return Number of valid frames since startup
+        * */
+        int getGoodFrames(bool &valid = Sensor::dummy);
+
+        /**
+        * @return Number of frames with a bad checksum since startup
+        * */
+        int getBadFrames(bool &valid = Sensor::dummy);
+
     private:
         USARTSerial * _serial;
+        EcuFrameParser _parser;
+        EcuStats _stats;
 
         uint32_t _lastUpdate = 0;
         bool _valid = false;
 
-        int _rpm = 0;
-        float _map = 0;
-        int _tps = 0;
-        int _ect = 0;
-        int _iat = 0;
-        float _o2s = 0;
-        int _spark = 0;
-        float _fuelPW1 = 0;
-        float _fuelPW2 = 0;
-        float _ubAdc = 0;
-
-        /**
-         * Helper for interpreting raw values from ECU
-         * @param high byte
-         * @param low byte
-         * @param factor 
-         * @param offset 
-         * @return Intepreted value
+        float _values[ECU_NUM_FIELDS] = { };
+        void (*_fuelCallback)(float, float, float) = NULL;
+
+        /**
+         * Updates all fields from a valid frame
          * */
-        float _interpretValue(uint8_t high, uint8_t low, float factor, float offset);
+        void _decodeFrame(const uint8_t* buffer);
 };
 
 #endif
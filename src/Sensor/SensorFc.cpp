@@ -3,7 +3,12 @@
 
 #define FC_BAUD         9600
 #define FC_STOP_CHAR    '*'
-#define PUBLISH_INTERVAL 5000
+// Fields not received for this long (ms) are invalid
+#define FC_STALE_INTERVAL 10000
+
+// Labels sent by the controller for each field, in the order of SensorFc::FieldId (matched ignoring case)
+const char* const FC_FIELD_LABELS[] = { "V", "I", "T1", "T2", "P" };
+static_assert(sizeof(FC_FIELD_LABELS) / sizeof(FC_FIELD_LABELS[0]) == SensorFc::NUM_FIELD_IDS, "FC_FIELD_LABELS doesn't match SensorFc::FieldId");
 
 SensorFc::SensorFc(USARTSerial *serial) {
     _serial = serial;
@@ -23,41 +28,115 @@ void SensorFc::handle() {
         char nextChar = _serial->read();
         if(nextChar == FC_STOP_CHAR) {
 
-            if(millis() >= _lastUpdate + PUBLISH_INTERVAL) {
-                _lastUpdate = millis();
-                _publish();
+            _buffer[_length] = '\0';
+            if(_overflowed) {
+                _keepRawFrame();
+            } else {
+                _parseFrame();
             }
+            _length = 0;
+            _overflowed = false;
+
+        } else if(_length < FC_BUFFER_SIZE - 1) {
+            _buffer[_length++] = nextChar;
+        } else if(!_overflowed) {
+            // drop the rest of the frame, a truncated frame could end mid-value
+            DEBUG_SERIAL_LN("ERROR: FC SERIAL BUFFER OVERFLOW");
+            _overflowed = true;
+        }
+    }
 
-            _emptyBuffer();
+}
 
-        } else {
+String SensorFc::getStackVoltage(bool &valid) {
+    valid = _isValid(StackVoltage);
+    return FLOAT_TO_STRING(_values[StackVoltage], 2);
+}
 
-            uint16_t position = 0;
-            while(position < FC_BUFFER_SIZE && _buffer[position]) {
-                position++;
-            }
+String SensorFc::getCurrent(bool &valid) {
+    valid = _isValid(Current);
+    return FLOAT_TO_STRING(_values[Current], 2);
+}
 
-            if(position >= FC_BUFFER_SIZE) {
-                DEBUG_SERIAL_LN("ERROR: FC SERIAL BUFFER OVERFLOW");
-                _publish();
-                _emptyBuffer();
-            }
+String SensorFc::getStackTemp(bool &valid) {
+    valid = _isValid(StackTemp);
+    return FLOAT_TO_STRING(_values[StackTemp], 1);
+}
 
-            _buffer[position] = nextChar;
+String SensorFc::getAmbientTemp(bool &valid) {
+    valid = _isValid(AmbientTemp);
+    return FLOAT_TO_STRING(_values[AmbientTemp], 1);
+}
+
+int SensorFc::getPurge(bool &valid) {
+    valid = _isValid(Purge);
+    return _values[Purge] != 0.0f ? 1 : 0;
+}
+
+String SensorFc::getRawFrame(bool &valid) {
+    valid = _rawPending;
+    _rawPending = false;
+    return valid ? String(_rawFrame) : "";
+}
+
+int SensorFc::getBadFrames(bool &valid) {
+    valid = true;
+    return _badFrames;
+}
+
+void SensorFc::_parseFrame() {
+    uint32_t now = millis();
+    bool known = false;
+
+    // fields are parsed without modifying the buffer so it can still be kept raw
+    const char* position = _buffer;
+    while (*position != '\0') {
+        const char* end = position + strcspn(position, ",\r\n");
+        const char* separator = position + strcspn(position, ":=,\r\n");
+
+        if (separator < end) {
+            // trim label
+            const char* label = position;
+            while (label < separator && *label == ' ') {
+                label++;
+            }
+            const char* labelEnd = separator;
+            while (labelEnd > label && *(labelEnd - 1) == ' ') {
+                labelEnd--;
+            }
+            size_t labelLength = labelEnd - label;
+
+            char* valueEnd;
+            float value = strtof(separator + 1, &valueEnd);
+            if (valueEnd != separator + 1 && valueEnd <= end) {
+                for (uint8_t i = 0; i < NUM_FIELD_IDS; i++) {
+                    if (strlen(FC_FIELD_LABELS[i]) == labelLength && strncasecmp(label, FC_FIELD_LABELS[i], labelLength) == 0) {
+                        _values[i] = value;
+                        _lastUpdates[i] = now;
+                        _received[i] = true;
+                        known = true;
+                        break;
+                    }
+                }
+            }
         }
+
+        position = *end != '\0' ? end + 1 : end;
     }
 
+    if (!known) {
+        _keepRawFrame();
+    }
 }
 
-void SensorFc::_publish() {
-    DEBUG_SERIAL_LN("---- FUEL CELL DATA ----");
-    DEBUG_SERIAL(_buffer);
-    DEBUG_SERIAL_LN("------------------------");
-    DEBUG_SERIAL_LN();
-
-    Particle.publish("fcdata", _buffer, PRIVATE, WITH_ACK);
+void SensorFc::_keepRawFrame() {
+    uint16_t length = min(_length, (uint16_t)FC_RAW_FRAME_SIZE);
+    memcpy(_rawFrame, _buffer, length);
+    _rawFrame[length] = '\0';
+    _badFrames++;
+    _rawPending = true;
 }
 
-void SensorFc::_emptyBuffer() {
-    memset(_buffer, 0, FC_BUFFER_SIZE);
+bool SensorFc::_isValid(FieldId field) {
+    return _received[field] && millis() - _lastUpdates[field] < FC_STALE_INTERVAL;
 }
@@ -4,12 +4,23 @@
 #include "Sensor.h"
 
 #define FC_BUFFER_SIZE 512
+// Longest raw frame logged when no field is recognized (bytes)
+#define FC_RAW_FRAME_SIZE 256
 
 // Fuel Cell Controller sensor - Temporary, can't be used in competition.
 // The nice thing about this sensor is that unless we hook up the specific
 // hardware for it, this sensor class essentially does nothing and can be left in. 
+//
+// Frames are text ended by '*', made of "label:value" (or "label=value") fields separated by commas or
+// line breaks. Fields are matched to FC_FIELD_LABELS (SensorFc.cpp), unknown labels are ignored. Frames without
+// any known field are kept as raw text (getRawFrame) so controller output still reaches the cloud.
 class SensorFc : public Sensor {
     public:
+        /**
+         * Index of each field in FC_FIELD_LABELS
+         **/
+        enum FieldId { StackVoltage, Current, StackTemp, AmbientTemp, Purge, NUM_FIELD_IDS };
+
         /**
          * Constructor 
          * @param *serial bus receiving Fuel Cell Controller data
@@ -22,27 +33,75 @@ class SensorFc : public Sensor {
         void begin() override;
         
         /**
-         * Check serial buffer for new updates
+         * Check serial buffer for new updates, parsing each complete frame
          * */
         void handle() override;
 
         String getHumanName() override;
 
+        /**
+         * @return Stack voltage, V
+         * */
+        String getStackVoltage(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Stack current, A
+         * */
+        String getCurrent(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Stack temperature, DegC
+         * */
+        String getStackTemp(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Ambient temperature, DegC
+         * */
+        String getAmbientTemp(bool &valid = Sensor::dummy);
+
+        /**
+         * @return 1 if hydrogen purge valve is open, 0 otherwise
+         * */
+        int getPurge(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Last frame (up to FC_RAW_FRAME_SIZE bytes) which overflowed the buffer or had no known field,
+         * once per frame (invalid until another such frame is received)
+         * */
+        String getRawFrame(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Number of frames that overflowed the buffer or had no known field since startup
+         * */
+        int getBadFrames(bool &valid = Sensor::dummy);
 
     private:
         USARTSerial * _serial;
         char _buffer[FC_BUFFER_SIZE];
-        uint32_t _lastUpdate = 0;
+        uint16_t _length = 0;
+        bool _overflowed = false;
+
+        float _values[NUM_FIELD_IDS] = { };
+        uint32_t _lastUpdates[NUM_FIELD_IDS] = { };
+        bool _received[NUM_FIELD_IDS] = { };
+        uint32_t _badFrames = 0;
+        char _rawFrame[FC_RAW_FRAME_SIZE + 1];
+        bool _rawPending = false;
+
+        /**
+         * Splits frame in buffer into fields and updates known ones
+         * */
+        void _parseFrame();
 
         /**
-         * Print to serial and publish message to Particle Cloud with buffer contents
+         * Counts frame in buffer as bad and keeps it for getRawFrame
          * */
-        void _publish();
+        void _keepRawFrame();
 
         /**
-         * Empty the buffer
+         * @return true if field has been received recently
          * */
-        void _emptyBuffer();
+        bool _isValid(FieldId field);
 };
 
 #endif
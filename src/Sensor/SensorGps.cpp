@@ -1,13 +1,16 @@
 #include <cmath>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "SensorGps.h"
 #include "settings.h"
-#include "gpsGreenlist.h"
+#include "TimeBase.h"
 
 // #define DEBUG_GPS
 
-// GPS Update Frequency in Hz (1-10)
-#define UPDATE_FREQ 4
+// GPS Update Frequency in Hz (1-10): every fix is buffered for the track
+#define UPDATE_FREQ 10
 
 // Math Constants
 #define MICROSECONDS_IN_SECOND      1000000
@@ -16,7 +19,33 @@
 #define TEN_POWER_SEVEN             10000000.0
 #define TEN_POWER_FIVE              100000.0
 
-SensorGps::SensorGps(SFE_UBLOX_GNSS *gps) {
+// Gps thread polls the receiver every GPS_POLL_INTERVAL_MS (ms)
+#define GPS_POLL_INTERVAL_MS        5
+#define GPS_THREAD_STACK_SIZE       OS_THREAD_STACK_SIZE_DEFAULT
+
+// Navigation database (ephemeris, almanac, AssistNow Autonomous orbits) is saved to this file every
+// GPS_NAV_SAVE_INTERVAL_MS (ms) while there is a fix and restored on begin()
+#define GPS_NAV_DATABASE_FILE       "/usr/gpsnav.dat"
+#define GPS_NAV_DATABASE_TEMP_FILE  "/usr/gpsnav.tmp"
+#define GPS_NAV_DATABASE_SIZE       8192
+#define GPS_NAV_SAVE_INTERVAL_MS    900000
+
+// Incline is invalid below this speed (m/s), where grade is dominated by altitude noise
+#define INCLINE_MIN_SPEED           1.0
+
+// Odometer ignores speeds below this (m/s) so gps drift isn't counted as distance while stationary
+#define ODOMETER_MIN_SPEED          0.5
+// Odometer isn't updated across gaps longer than this (us), e.g. on first fix
+#define ODOMETER_MAX_GAP            2000000
+
+#ifdef GPS_TIMEPULSE_PIN
+void timepulseInterrupt() {
+    TimeBase::instance().timepulse();
+}
+#endif
+
+SensorGps::SensorGps(SFE_UBLOX_GNSS *gps)
+    : _speedFilter(2, GPS_HORIZONTAL_PROCESS_NOISE), _altitudeFilter(3, GPS_VERTICAL_PROCESS_NOISE) {
     _gps = gps;
 }
 
@@ -33,116 +62,192 @@ void SensorGps::begin() {
     _gps->setAutoPVT(true);
     // Set the update frequency.  The Sparkfun GNSS library will automatically limit checks to UPDATE_FREQ times per second
     _gps->setNavigationFrequency(UPDATE_FREQ);
+    // AssistNow Autonomous: receiver extends broadcast ephemeris into orbit predictions valid for days
+    _gps->setAopCfg(1);
+    _restoreNavDatabase();
+
+    _geoFence.load();
 
+    #ifdef GPS_TIMEPULSE_PIN
+        // default TIMEPULSE: rising edge at the top of each UTC second
+        pinMode(GPS_TIMEPULSE_PIN, INPUT);
+        attachInterrupt(GPS_TIMEPULSE_PIN, timepulseInterrupt, RISING);
+    #endif
+
+    // configuration above is done before the gps thread owns the receiver
+    os_mutex_create(&_mutex);
+    _thread = new Thread("gps", _threadFunction, this, OS_THREAD_PRIORITY_DEFAULT, GPS_THREAD_STACK_SIZE);
 }
 
 void SensorGps::handle() {
-    _gps->checkUblox();
+    uint32_t handleStart = micros();
+
+    // never wait on the gps thread: if it is publishing a fix, pick it up next loop
+    bool newFix = false;
+    uint32_t fixMillis = 0;
+    if (os_mutex_trylock(_mutex) == 0) {
+        if (_sharedNew) {
+            _pvt = _sharedPvt;
+            fixMillis = _sharedMillis;
+            _sharedNew = false;
+            newFix = true;
+        }
+        os_mutex_unlock(_mutex);
+    }
+
+    if (newFix) {
+        _processFix(fixMillis);
+    }
+
+    uint32_t handleMicros = micros() - handleStart;
+    if (handleMicros > _handleMaxMicros) {
+        _handleMaxMicros = handleMicros;
+    }
+}
+
+void SensorGps::_threadFunction(void* param) {
+    SensorGps* sensor = (SensorGps*)param;
+    Pvt pvt;
+
+    while (true) {
+        uint32_t i2cStart = micros();
+        uint32_t pollMillis = millis();
+
+        // with autoPVT, getPVT checks for new data and returns true once per navigation solution (UPDATE_FREQ times per second)
+        bool newFix;
+        WITH_LOCK(Wire) {
+            newFix = sensor->_gps->getPVT(0);
+            if (newFix) {
+                sensor->_readPvt(pvt);
+            }
+        }
+        uint32_t i2cMicros = micros() - i2cStart;
+
+        os_mutex_lock(sensor->_mutex);
+        if (newFix) {
+            sensor->_sharedPvt = pvt;
+            sensor->_sharedMillis = pollMillis;
+            sensor->_sharedNew = true;
+        }
+        sensor->_i2cMicros += i2cMicros;
+        sensor->_i2cReadCount++;
+        bool saveNavDatabase = sensor->_navSaveRequested;
+        sensor->_navSaveRequested = false;
+        os_mutex_unlock(sensor->_mutex);
+
+        if (saveNavDatabase) {
+            sensor->_saveNavDatabase();
+        }
+
+        delay(GPS_POLL_INTERVAL_MS);
+    }
+}
+
+void SensorGps::_processFix(uint32_t fixMillis) {
+    // geofence is checked once per fix rather than in every position getter (in this thread, as zones can change)
+    _pvt.inGreenlist = _geoFence.contains(_pvt.latitude, _pvt.longitude);
+
+    if (_pvt.timeValid) {
+        TimeBase::instance().discipline(_pvt.unixEpoch, _pvt.nanosecond, fixMillis);
+    }
 
     // Calculate the current microsecond
-    uint64_t thisUpdateMicros = (_gps->getUnixEpoch() * MICROSECONDS_IN_SECOND) + (_gps->getNanosecond() / NANOSECONDS_IN_MICROSECOND);
+    uint64_t thisUpdateMicros = ((uint64_t)_pvt.unixEpoch * MICROSECONDS_IN_SECOND) + (_pvt.nanosecond / NANOSECONDS_IN_MICROSECOND);
 
-    // Check to see if there has been an update (gps data is updated UPDATE_FREQ times per second, so this returns true at that rate)
     if(thisUpdateMicros != _lastUpdateMicros){
 		
         uint64_t elapsedMicroseconds = thisUpdateMicros - _lastUpdateMicros;
 
-        // Calculate XY Acceleration
-        float horizontalSpeed = _gps->getGroundSpeed() / MILIMETERS_IN_METERS;
+        float dt = elapsedMicroseconds / (float)MICROSECONDS_IN_SECOND;
+
+        // Filtered XY Acceleration
+        float horizontalSpeed = _pvt.groundSpeed / MILIMETERS_IN_METERS;
         if (_speedCallback) {
             _speedCallback(horizontalSpeed); 
         }
-        _horizontalAcceleration = ((horizontalSpeed - _lastHorizontalSpeed) * MICROSECONDS_IN_SECOND) / elapsedMicroseconds;
-        _lastHorizontalSpeed = horizontalSpeed;
-        _horizontalDistance = horizontalSpeed * elapsedMicroseconds / MICROSECONDS_IN_SECOND;
-
-        // Calculate Z Speed
-        float altitude = _gps->getAltitudeMSL() / MILIMETERS_IN_METERS;
-        _verticalSpeed = ((altitude - _lastAltitude) * MICROSECONDS_IN_SECOND) / elapsedMicroseconds;
-        _verticalDistance = altitude - _lastAltitude;
-        _lastAltitude = altitude;
+        _speedFilter.update(horizontalSpeed, _pvt.speedAccuracy / MILIMETERS_IN_METERS, dt);
+        _horizontalAcceleration = _speedFilter.getRate();
+        float horizontalDistance = horizontalSpeed * elapsedMicroseconds / MICROSECONDS_IN_SECOND;
+        if (_valid && horizontalSpeed >= ODOMETER_MIN_SPEED && elapsedMicroseconds < ODOMETER_MAX_GAP) {
+            _odometer += horizontalDistance;
+        }
 
-        // Calculate Z Acceleration
-        _verticalAcceleration = ((_verticalSpeed - _lastVerticalSpeed) * MICROSECONDS_IN_SECOND) / elapsedMicroseconds;
-        _lastVerticalSpeed = _verticalSpeed;
+        // Filtered Z Speed and Acceleration
+        float altitude = _pvt.altitudeMsl / MILIMETERS_IN_METERS;
+        _altitudeFilter.update(altitude, _pvt.verticalAccuracy / MILIMETERS_IN_METERS, dt);
+        _verticalSpeed = _altitudeFilter.getRate();
+        _verticalAcceleration = _altitudeFilter.getAcceleration();
 
         _lastUpdateMicros = thisUpdateMicros;
 
         #ifdef DEBUG_GPS
             DEBUG_SERIAL("SIV: ");
-            DEBUG_SERIAL(_gps->getSIV());
+            DEBUG_SERIAL(_pvt.satellites);
             DEBUG_SERIAL(" - Accuracy X: ");
-            DEBUG_SERIAL(_gps->getHorizontalAccEst() / MILIMETERS_IN_METERS);
+            DEBUG_SERIAL(_pvt.horizontalAccuracy / MILIMETERS_IN_METERS);
             DEBUG_SERIAL("m - Accuracy Y: ");
-            DEBUG_SERIAL(_gps->getVerticalAccEst() / MILIMETERS_IN_METERS);
+            DEBUG_SERIAL(_pvt.verticalAccuracy / MILIMETERS_IN_METERS);
             DEBUG_SERIAL_LN("m");
         #endif
     }
 
-    float value = _gps->getHorizontalAccEst() / MILIMETERS_IN_METERS;
+    float value = _pvt.horizontalAccuracy / MILIMETERS_IN_METERS;
     if (value > 0.0001 && value < 1000.0) {
         _valid = true;
     } else{
         _valid = false;
     }
-        
+
+    if (_valid && !_hasFirstFix) {
+        _firstFixMillis = fixMillis;
+        _lastNavSaveMillis = fixMillis;
+        _hasFirstFix = true;
+    }
+
+    if (_valid && fixMillis - _lastNavSaveMillis >= GPS_NAV_SAVE_INTERVAL_MS) {
+        os_mutex_lock(_mutex);
+        _navSaveRequested = true;
+        os_mutex_unlock(_mutex);
+        _lastNavSaveMillis = fixMillis;
+    }
+
+    if (_valid && _fixCallback) {
+        _fixCallback(_pvt);
+    }
+
+    if (_valid && _isPositionAllowed()) {
+        _pushTrackPoint();
+    } else {
+        _flushTrack();
+    }
 }
 
 bool SensorGps::getTimeValid() {
-    return _gps->getTimeValid();
+    return _pvt.timeValid;
 }
 
 uint32_t SensorGps::getUnixTime() {
-    return _gps->getUnixEpoch();
+    return _pvt.unixEpoch;
 }
 
 String SensorGps::getLongitude(bool &valid) {
-    valid = false;
-    double longitude = _gps->getLongitude() / TEN_POWER_SEVEN;
-    double latitude = _gps->getLatitude() / TEN_POWER_SEVEN;
-
-    if(_override) {
-        valid = _valid;
-    } else {
-        for(positionBox p : GREEN_LIST) {
-            if(p.isWithin(longitude, latitude)) {
-                valid = _valid;
-                break;
-            }
-        }
-    }
-    
-    return FLOAT_TO_STRING(longitude, 6);
+    valid = _valid && _isPositionAllowed();
+    return FLOAT_TO_STRING(_pvt.longitude / TEN_POWER_SEVEN, 6);
 }
 
 String SensorGps::getLatitude(bool &valid) {
-    valid = false;
-
-    double longitude = _gps->getLongitude() / TEN_POWER_SEVEN;
-    double latitude = _gps->getLatitude() / TEN_POWER_SEVEN;
-
-    if (_override) {
-        valid = _valid;
-    } else {
-        for (positionBox p : GREEN_LIST) {
-            if (p.isWithin(longitude, latitude)) {
-                valid = _valid;
-                break;
-            }
-        }
-    }
-
-    return FLOAT_TO_STRING(latitude, 6);
+    valid = _valid && _isPositionAllowed();
+    return FLOAT_TO_STRING(_pvt.latitude / TEN_POWER_SEVEN, 6);
 }
 
 int SensorGps::getHeading(bool &valid) {
     valid = _valid;
-    return _gps->getHeading() / TEN_POWER_FIVE;    
+    return _pvt.heading / TEN_POWER_FIVE;    
 }
 
 String SensorGps::getHorizontalSpeed(bool &valid) {
     valid = _valid;
-    return FLOAT_TO_STRING(_gps->getGroundSpeed() / MILIMETERS_IN_METERS, 2);  
+    return FLOAT_TO_STRING(_pvt.groundSpeed / MILIMETERS_IN_METERS, 2);  
 }
 
 String SensorGps::getHorizontalAcceleration(bool &valid) {
@@ -152,7 +257,7 @@ String SensorGps::getHorizontalAcceleration(bool &valid) {
 
 String SensorGps::getHorizontalAccuracy(bool &valid) {
     valid = _valid;
-    float value = _gps->getHorizontalAccEst() / MILIMETERS_IN_METERS;
+    float value = _pvt.horizontalAccuracy / MILIMETERS_IN_METERS;
     if (value > 1000.0){
         return "1000.00";
     }
@@ -161,7 +266,7 @@ String SensorGps::getHorizontalAccuracy(bool &valid) {
 
 String SensorGps::getAltitude(bool &valid) {
     valid = _valid;
-    return FLOAT_TO_STRING(_gps->getAltitudeMSL() / MILIMETERS_IN_METERS, 2);  
+    return FLOAT_TO_STRING(_pvt.altitudeMsl / MILIMETERS_IN_METERS, 2);  
 }
 
 String SensorGps::getVerticalSpeed(bool &valid) {
@@ -176,7 +281,7 @@ String SensorGps::getVerticalAcceleration(bool &valid) {
 
 String SensorGps::getVerticalAccuracy(bool &valid) {
     valid = _valid;
-    float value = _gps->getVerticalAccEst() / MILIMETERS_IN_METERS;
+    float value = _pvt.verticalAccuracy / MILIMETERS_IN_METERS;
     if (value > 1000.0){
         return "1000.00";
     }
@@ -184,24 +289,218 @@ String SensorGps::getVerticalAccuracy(bool &valid) {
 }
 
 String SensorGps::getIncline(bool &valid) {
-    valid = true;
-    double inclineInRadians = atan(_verticalDistance / _horizontalDistance);
-    _verticalDistance = 0;
-	_horizontalDistance = 0;
+    float horizontalSpeed = _speedFilter.getValue();
+    valid = _valid && horizontalSpeed >= INCLINE_MIN_SPEED;
+    double inclineInRadians = atan2(_verticalSpeed, horizontalSpeed);
     return FLOAT_TO_STRING(degrees(inclineInRadians), 2);
 }
 
 int SensorGps::getSatellitesInView(bool &valid) {
     valid = true;
-    return _gps->getSIV();
+    return _pvt.satellites;
+}
+
+String SensorGps::getTrack(bool &valid) {
+    valid = _trackCount > 0;
+    if (!valid) {
+        return "";
+    }
+
+    CompactEncoder encoder;
+    uint8_t tail = (_trackHead + GPS_TRACK_BUFFER_SIZE - _trackCount) % GPS_TRACK_BUFFER_SIZE;
+    const TrackPoint& first = _track[tail];
+    encoder.addUnsigned(first.unixEpoch);
+    encoder.addUnsigned(first.millisecond);
+
+    TrackPoint previous = { first.unixEpoch, first.millisecond, 0, 0, 0, 0 };
+    while (_trackCount > 0) {
+        const TrackPoint& point = _track[tail];
+
+        uint32_t elapsed = (point.unixEpoch - previous.unixEpoch) * 1000 + point.millisecond - previous.millisecond;
+        int32_t heading = (int32_t)point.heading - previous.heading;
+        if (heading > 18000) heading -= 36000;
+        if (heading < -18000) heading += 36000;
+
+        // stop once a whole point no longer fits: it will start the next segment
+        uint16_t length = encoder.getLength();
+        bool added = encoder.addUnsigned(elapsed) &&
+            encoder.addSigned(point.latitude - previous.latitude) &&
+            encoder.addSigned(point.longitude - previous.longitude) &&
+            encoder.addSigned((int32_t)point.speed - previous.speed) &&
+            encoder.addSigned(heading);
+        if (!added) {
+            encoder.truncate(length);
+            break;
+        }
+
+        previous = point;
+        tail = (tail + 1) % GPS_TRACK_BUFFER_SIZE;
+        _trackCount--;
+    }
+
+    return encoder.toBase64();
+}
+
+const SensorGps::Pvt& SensorGps::getPvt() {
+    return _pvt;
+}
+
+int SensorGps::getI2cTime(bool &valid) {
+    os_mutex_lock(_mutex);
+    valid = _i2cReadCount > 0;
+    int average = valid ? _i2cMicros / _i2cReadCount : 0;
+    _i2cMicros = 0;
+    _i2cReadCount = 0;
+    os_mutex_unlock(_mutex);
+    return average;
+}
+
+int SensorGps::getHandleTime(bool &valid) {
+    valid = true;
+    int maxMicros = _handleMaxMicros;
+    _handleMaxMicros = 0;
+    return maxMicros;
+}
+
+String SensorGps::getTimeToFirstFix(bool &valid) {
+    valid = _hasFirstFix;
+    return String(_firstFixMillis / 1000) + "." + String(_firstFixMillis % 1000 / 100);
+}
+
+double SensorGps::getOdometer() {
+    return _odometer;
 }
 
 void SensorGps::setSpeedCallback(void (*speed)(float)){
    _speedCallback  = speed;
 }
 
+int SensorGps::geofenceCommand(String command) {
+    return _geoFence.command(command);
+}
+
+void SensorGps::setFixCallback(void (*fix)(const Pvt&)) {
+    _fixCallback = fix;
+}
+
 void SensorGps::toggleOverride() {
     _override = !_override;
 }
 
+void SensorGps::_readPvt(Pvt& pvt) {
+    pvt.unixEpoch = _gps->getUnixEpoch();
+    pvt.nanosecond = _gps->getNanosecond();
+    pvt.longitude = _gps->getLongitude();
+    pvt.latitude = _gps->getLatitude();
+    pvt.altitudeMsl = _gps->getAltitudeMSL();
+    pvt.groundSpeed = _gps->getGroundSpeed();
+    pvt.heading = _gps->getHeading();
+    pvt.horizontalAccuracy = _gps->getHorizontalAccEst();
+    pvt.verticalAccuracy = _gps->getVerticalAccEst();
+    pvt.speedAccuracy = _gps->getSpeedAccEst();
+    pvt.satellites = _gps->getSIV();
+    pvt.timeValid = _gps->getTimeValid();
+}
+
+void SensorGps::_restoreNavDatabase() {
+    // approximate time lets the receiver use restored orbits immediately (rtc is kept across resets)
+    if (Time.isValid()) {
+        time_t now = Time.now();
+        struct tm* utc = gmtime(&now);
+        _gps->setUTCTimeAssistance(utc->tm_year + 1900, utc->tm_mon + 1, utc->tm_mday, utc->tm_hour, utc->tm_min, utc->tm_sec);
+    }
+
+    int file = open(GPS_NAV_DATABASE_FILE, O_RDONLY);
+    if (file < 0) {
+        return;
+    }
+
+    uint8_t* buffer = new uint8_t[GPS_NAV_DATABASE_SIZE];
+    int length = read(file, buffer, GPS_NAV_DATABASE_SIZE);
+    close(file);
+
+    size_t restored = length > 0 ? _gps->pushAssistNowData(buffer, length) : 0;
+    delete[] buffer;
+
+    DEBUG_SERIAL_LN("GPS: restored " + String(restored) + " bytes of navigation data");
+}
+
+void SensorGps::_saveNavDatabase() {
+    uint8_t* buffer = new uint8_t[GPS_NAV_DATABASE_SIZE];
+    size_t length;
+    WITH_LOCK(Wire) {
+        length = _gps->readNavigationDatabase(buffer, GPS_NAV_DATABASE_SIZE);
+    }
+
+    // write then rename so a reset mid-write never leaves a truncated database
+    if (length > 0) {
+        int file = open(GPS_NAV_DATABASE_TEMP_FILE, O_WRONLY | O_CREAT | O_TRUNC);
+        if (file >= 0) {
+            bool written = write(file, buffer, length) == (int)length;
+            close(file);
+            if (written) {
+                rename(GPS_NAV_DATABASE_TEMP_FILE, GPS_NAV_DATABASE_FILE);
+            }
+        }
+    }
+    delete[] buffer;
+}
+
+void SensorGps::setTrackSimplifier(TrackSimplifier* simplifier) {
+    _simplifier = simplifier;
+}
 
+void SensorGps::_pushTrackPoint() {
+    TrackPoint point;
+    point.unixEpoch = _pvt.unixEpoch;
+    point.millisecond = (_pvt.nanosecond > 0 ? _pvt.nanosecond : 0) / 1000000;
+    point.speed = constrain(_pvt.groundSpeed / 10, 0, 0xFFFF);
+    point.longitude = _pvt.longitude;
+    point.latitude = _pvt.latitude;
+    point.heading = (_pvt.heading / 1000) % 36000;
+
+    if (_simplifier == NULL) {
+        _appendTrackPoint(point);
+        return;
+    }
+
+    switch (_simplifier->add(point.latitude, point.longitude)) {
+        case TrackSimplifier::EmitCurrent:
+            _appendTrackPoint(point);
+            break;
+        case TrackSimplifier::Hold:
+            _trackFloater = point;
+            _hasFloater = true;
+            break;
+        case TrackSimplifier::EmitFloater:
+            _appendTrackPoint(_trackFloater);
+            _trackFloater = point;
+            _hasFloater = true;
+            break;
+    }
+}
+
+void SensorGps::_flushTrack() {
+    if (_simplifier == NULL) {
+        return;
+    }
+
+    // end of segment: keep its last point, next valid fix starts a new anchor
+    if (_hasFloater) {
+        _appendTrackPoint(_trackFloater);
+        _hasFloater = false;
+    }
+    _simplifier->reset();
+}
+
+void SensorGps::_appendTrackPoint(const TrackPoint& point) {
+    _track[_trackHead] = point;
+    _trackHead = (_trackHead + 1) % GPS_TRACK_BUFFER_SIZE;
+    if (_trackCount < GPS_TRACK_BUFFER_SIZE) {
+        _trackCount++;
+    }
+}
+
+bool SensorGps::_isPositionAllowed() {
+    return _override || _pvt.inGreenlist;
+}
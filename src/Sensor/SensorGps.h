@@ -3,9 +3,46 @@
 
 #include "SparkFun_u-blox_GNSS_Arduino_Library.h"
 #include "Sensor.h"
+#include "CompactEncoder.h"
+#include "TrackSimplifier.h"
+#include "GeoFence.h"
+#include "KinematicFilter.h"
+
+// Number of fixes buffered for the track (oldest fixes are dropped when full)
+#define GPS_TRACK_BUFFER_SIZE 32
 
 class SensorGps : public Sensor {
     public:
+        /**
+         * @brief One consistent navigation solution, copied from the GNSS library once per fix
+         **/
+        struct Pvt {
+            uint32_t unixEpoch;             // s
+            int32_t nanosecond;             // ns, fraction of unixEpoch
+            int32_t longitude;              // degrees * 1e-7
+            int32_t latitude;               // degrees * 1e-7
+            int32_t altitudeMsl;            // mm
+            int32_t groundSpeed;            // mm/s
+            int32_t heading;                // degrees * 1e-5
+            uint32_t horizontalAccuracy;    // mm
+            uint32_t verticalAccuracy;      // mm
+            uint32_t speedAccuracy;         // mm/s
+            uint8_t satellites;
+            bool timeValid;
+            bool inGreenlist;               // position is within a geofence zone
+        };
+
+        /**
+         * @brief Buffered fix for the track (raw u-blox units)
+         **/
+        struct TrackPoint {
+            uint32_t unixEpoch;             // s
+            uint16_t millisecond;           // ms, fraction of unixEpoch
+            uint16_t speed;                 // cm/s
+            int32_t longitude;              // degrees * 1e-7
+            int32_t latitude;               // degrees * 1e-7
+            uint16_t heading;               // degrees * 1e-2
+        };
 
         /**
          * Constructor
@@ -20,7 +57,7 @@ class SensorGps : public Sensor {
         void begin() override;
 
         /**
-         * Polls GPS for any new data. Run as frequently as possible 
+         * Processes the latest fix read by the gps thread, never blocks on i2c
          **/
         void handle() override;
 
@@ -57,7 +94,7 @@ class SensorGps : public Sensor {
         String getHorizontalSpeed(bool &valid = Sensor::dummy);
 
         /**
-         * @return Horizontal acceleration (m/s^2)
+         * @return Horizontal acceleration (m/s^2), Kalman filtered
          **/
         String getHorizontalAcceleration(bool &valid = Sensor::dummy);
 
@@ -72,12 +109,12 @@ class SensorGps : public Sensor {
         String getAltitude(bool &valid = Sensor::dummy);
 
         /**
-         * @return Vertical speed (m/s)
+         * @return Vertical speed (m/s), Kalman filtered
          **/
         String getVerticalSpeed(bool &valid = Sensor::dummy);
         
         /**
-         * @return Vertical acceleration b (m/s^2)
+         * @return Vertical acceleration (m/s^2), Kalman filtered
          **/
         String getVerticalAcceleration(bool &valid = Sensor::dummy);
 
@@ -87,7 +124,8 @@ class SensorGps : public Sensor {
         String getVerticalAccuracy(bool &valid = Sensor::dummy);
 
 		/**
-		 * @brief Incline -- arctan(vertical distance / horizontal distance)
+		 * @brief Incline -- arctan(vertical speed / horizontal speed) from filtered speeds (degrees),
+		 * invalid while nearly stationary
 		 * 
 		 */
         String getIncline(bool &valid = Sensor::dummy);
@@ -97,6 +135,42 @@ class SensorGps : public Sensor {
          **/
         int getSatellitesInView(bool &valid = Sensor::dummy);
 
+        /**
+         * @brief Every valid fix (within the greenlist) since the last call, as a compact track segment:
+         * 
+         * unixEpoch and millisecond of first fix, then for each fix: time (ms), latitude, longitude, speed and
+         * heading as differences from the previous fix (first fix from 0), written with CompactEncoder
+         * (time unsigned, others signed; heading difference wraps to +/-180 degrees)
+         * 
+         * @note fixes which don't fit in one segment are returned by the next call
+         **/
+        String getTrack(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Latest navigation solution
+         **/
+        const Pvt& getPvt();
+
+        /**
+         * @return Average time (us) the gps thread spent per i2c poll since the last call
+         **/
+        int getI2cTime(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Longest time (us) handle() blocked the main loop since the last call
+         **/
+        int getHandleTime(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Time from boot to the first valid fix (s)
+         **/
+        String getTimeToFirstFix(bool &valid = Sensor::dummy);
+
+        /**
+         * @return Distance travelled since startup (m), integrated from ground speed
+         **/
+        double getOdometer();
+
         /**
          * @brief Update the callback function used by GPS to notify higher-level class of new GPS speed
          * 
@@ -104,6 +178,26 @@ class SensorGps : public Sensor {
          **/
         void setSpeedCallback(void (*speed)(float));
 
+        /**
+         * @brief Update the callback function called with every valid fix (at the full navigation rate)
+         * 
+         * @param fix() Pointer to function to call with the new navigation solution
+         **/
+        void setFixCallback(void (*fix)(const Pvt&));
+
+        /**
+         * @brief Simplify the track before buffering it: fixes within the simplifier tolerance of the
+         * buffered track are dropped. NULL (default) buffers every fix
+         **/
+        void setTrackSimplifier(TrackSimplifier* simplifier);
+
+        /**
+         * @brief Runs a geofence zone command (see GeoFence::command)
+         * 
+         * @return number of zones, or -1 if command failed
+         **/
+        int geofenceCommand(String command);
+
         /**
          * @brief Toggle greenlist override
          **/
@@ -114,21 +208,94 @@ class SensorGps : public Sensor {
         uint8_t _updateFrequency;
 
         bool _valid = false;
+        Pvt _pvt = { };
+        GeoFence _geoFence;
+
+        // gps thread: owns the receiver after begin(), shares fixes through _mutex
+        Thread* _thread = NULL;
+        os_mutex_t _mutex;
+        Pvt _sharedPvt = { };
+        uint32_t _sharedMillis = 0;
+        bool _sharedNew = false;
+        bool _navSaveRequested = false;
+
+        // time to first fix and navigation database persistence
+        bool _hasFirstFix = false;
+        uint32_t _firstFixMillis = 0;
+        uint32_t _lastNavSaveMillis = 0;
+
+        // track ring buffer
+        TrackPoint _track[GPS_TRACK_BUFFER_SIZE];
+        uint8_t _trackHead = 0;
+        uint8_t _trackCount = 0;
+        TrackSimplifier* _simplifier = NULL;
+        TrackPoint _trackFloater = { };
+        bool _hasFloater = false;
+
+        // i2c and loop time instrumentation
+        uint32_t _i2cMicros = 0;
+        uint32_t _i2cReadCount = 0;
+        uint32_t _handleMaxMicros = 0;
 
         uint64_t _lastUpdateMicros = 0;
 
-        float _lastHorizontalSpeed = 0.0;
+        KinematicFilter _speedFilter;
+        KinematicFilter _altitudeFilter;
         float _horizontalAcceleration = 0.0;
-
-        float _lastAltitude = 0.0;
         float _verticalSpeed = 0.0;
-        float _lastVerticalSpeed = 0.0;
         float _verticalAcceleration = 0.0;
-        float _horizontalDistance = 0.0;
-        float _verticalDistance = 0.0;
+        double _odometer = 0.0;
         void (*_speedCallback)(float) = NULL;
+        void (*_fixCallback)(const Pvt&) = NULL;
         bool _override = false;
 
+        /**
+         * @brief Polls receiver and shares each new fix with handle(), runs forever in the gps thread
+         **/
+        static void _threadFunction(void* param);
+
+        /**
+         * @brief Sends saved navigation database (and rtc time if valid) to the receiver
+         **/
+        void _restoreNavDatabase();
+
+        /**
+         * @brief Reads navigation database from the receiver and saves it to flash (gps thread)
+         **/
+        void _saveNavDatabase();
+
+        /**
+         * @brief Copies latest navigation solution from GNSS library into pvt (gps thread)
+         **/
+        void _readPvt(Pvt& pvt);
+
+        /**
+         * @brief Updates derived values, time base and track from a new fix in _pvt
+         *
+         * @param fixMillis millis() when the fix was read
+         **/
+        void _processFix(uint32_t fixMillis);
+
+        /**
+         * @brief Adds latest fix to track buffer (through the simplifier if set)
+         **/
+        void _pushTrackPoint();
+
+        /**
+         * @brief Buffers the simplifier's pending point and restarts simplification (fix lost or outside greenlist)
+         **/
+        void _flushTrack();
+
+        /**
+         * @brief Adds point to track ring buffer, dropping the oldest point when full
+         **/
+        void _appendTrackPoint(const TrackPoint& point);
+
+        /**
+         * @return true if position is within a geofence zone (or greenlist is overridden)
+         **/
+        bool _isPositionAllowed();
+
 };
 
 #endif
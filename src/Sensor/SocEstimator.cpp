@@ -0,0 +1,104 @@
+#include "SocEstimator.h"
+#include "settings.h"
+
+#define MICROSECONDS_IN_SECOND  1000000
+#define SECONDS_IN_HOUR         3600
+
+// Pack is at rest (voltage close to open circuit voltage) once |current| stays below this (mA) for REST_TIME_MS
+#define REST_CURRENT_MA         2000
+#define REST_TIME_MS            30000
+// While at rest, charge moves 1 / 2^OCV_CORRECTION_SHIFT of the way to the OCV estimate every OCV_CORRECTION_INTERVAL_MS
+#define OCV_CORRECTION_SHIFT    4
+#define OCV_CORRECTION_INTERVAL_MS 1000
+// Samples further apart than this (us) aren't integrated
+#define MAX_SAMPLE_GAP          1000000
+
+// Open circuit cell voltage (mV) at 0, 10, ... 100 % state of charge (NMC)
+const int16_t OCV_TABLE[] = { 3000, 3450, 3550, 3620, 3680, 3740, 3800, 3880, 3960, 4060, 4180 };
+#define OCV_TABLE_SIZE          (sizeof(OCV_TABLE) / sizeof(OCV_TABLE[0]))
+
+SocEstimator::SocEstimator(EnergyIntegrator* energy, uint32_t capacityMah, uint8_t seriesCells)
+    : _energy(energy), _capacityMas((int64_t)capacityMah * SECONDS_IN_HOUR), _seriesCells(seriesCells) { }
+
+void SocEstimator::begin() { }
+
+void SocEstimator::handle() { }
+
+String SocEstimator::getHumanName() {
+    return "SocEstimator";
+}
+
+void SocEstimator::addSample(float voltage, float current) {
+    uint32_t time = micros();
+    int32_t cellVoltage = (int32_t)(voltage * 1000.0f) / _seriesCells;
+    int32_t currentMa = (int32_t)(current * 1000.0f);
+
+    if (!_initialized) {
+        _charge = _chargeAtVoltage(cellVoltage);
+        _initialized = true;
+    } else {
+        uint32_t elapsed = time - _lastSampleMicros;
+        if (elapsed < MAX_SAMPLE_GAP) {
+            _chargeRemainder -= (int64_t)currentMa * elapsed;
+            int64_t whole = _chargeRemainder / MICROSECONDS_IN_SECOND;
+            _chargeRemainder -= whole * MICROSECONDS_IN_SECOND;
+            _charge += whole;
+        }
+    }
+    _lastSampleMicros = time;
+    _lastVoltage = cellVoltage;
+
+    // open circuit voltage correction once resting
+    uint32_t now = millis();
+    if (abs(currentMa) >= REST_CURRENT_MA) {
+        _resting = false;
+    } else if (!_resting) {
+        _resting = true;
+        _restStartMillis = now;
+    } else if (now - _restStartMillis >= REST_TIME_MS && now - _lastCorrectionMillis >= OCV_CORRECTION_INTERVAL_MS) {
+        _charge += (_chargeAtVoltage(cellVoltage) - _charge) >> OCV_CORRECTION_SHIFT;
+        _lastCorrectionMillis = now;
+    }
+
+    _charge = constrain(_charge, (int64_t)0, _capacityMas);
+}
+
+String SocEstimator::getSoc(bool& valid) {
+    valid = _initialized;
+    int32_t soc = _socPermille();
+    return String(soc / 10) + "." + String(soc % 10);
+}
+
+String SocEstimator::getRange(bool& valid) {
+    float whPerKm = _energy->getWhPerKm();
+    valid = _initialized && whPerKm > 0.0f;
+    if (!valid) {
+        return "0";
+    }
+
+    // remaining energy at present pack voltage
+    float remainingWh = (_charge / (float)SECONDS_IN_HOUR / 1000.0f) * (_lastVoltage * _seriesCells / 1000.0f);
+    return FLOAT_TO_STRING(remainingWh / whPerKm, 1);
+}
+
+int64_t SocEstimator::_chargeAtVoltage(int32_t cellVoltage) {
+    if (cellVoltage <= OCV_TABLE[0]) {
+        return 0;
+    }
+    if (cellVoltage >= OCV_TABLE[OCV_TABLE_SIZE - 1]) {
+        return _capacityMas;
+    }
+
+    uint8_t i = 1;
+    while (cellVoltage > OCV_TABLE[i]) {
+        i++;
+    }
+
+    // permille of capacity, interpolated between table points 10 % apart
+    int32_t permille = (i - 1) * 100 + (cellVoltage - OCV_TABLE[i - 1]) * 100 / (OCV_TABLE[i] - OCV_TABLE[i - 1]);
+    return _capacityMas * permille / 1000;
+}
+
+int32_t SocEstimator::_socPermille() {
+    return _capacityMas > 0 ? (int32_t)(_charge * 1000 / _capacityMas) : 0;
+}
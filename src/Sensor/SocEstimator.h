@@ -0,0 +1,80 @@
+#ifndef _SOC_ESTIMATOR_H_
+#define _SOC_ESTIMATOR_H_
+
+#include "Sensor.h"
+#include "EnergyIntegrator.h"
+
+/**
+ * @brief Onboard state of charge and remaining range estimate
+ *
+ * Charge is counted from every bms current update (coulomb counting, integer mA and us so no drift from
+ * rounding) and pulled towards the open circuit voltage lookup while the pack is at rest, which corrects
+ * integration error and capacity mismatch. The first sample initializes charge from the lookup.
+ *
+ * @note feed with addSample() from the bms power callback (see CanSensorBms::setPowerCallback)
+ */
+class SocEstimator : public Sensor {
+    public:
+        /**
+         * Constructor
+         *
+         * @param energy energy integrator whose efficiency (Wh/km) is used for range
+         * @param capacityMah usable pack capacity (mAh)
+         * @param seriesCells number of cells in series (pack voltage / seriesCells gives cell voltage for lookup)
+         */
+        SocEstimator(EnergyIntegrator* energy, uint32_t capacityMah, uint8_t seriesCells);
+
+        void begin() override;
+
+        void handle() override;
+
+        String getHumanName() override;
+
+        /**
+         * @brief Integrates current since previous sample and applies open circuit voltage correction while at rest
+         *
+         * @param voltage battery voltage (V)
+         * @param current battery current (A), positive when discharging
+         */
+        void addSample(float voltage, float current);
+
+        /**
+         * @return Estimated state of charge (%)
+         */
+        String getSoc(bool& valid = Sensor::dummy);
+
+        /**
+         * @return Estimated remaining range (km) at average efficiency since startup
+         */
+        String getRange(bool& valid = Sensor::dummy);
+
+    private:
+        EnergyIntegrator* _energy;
+        const int64_t _capacityMas;
+        const uint8_t _seriesCells;
+
+        // Charge remaining (mA·s) and sub mA·s remainder of integration (mA·us)
+        int64_t _charge = 0;
+        int64_t _chargeRemainder = 0;
+
+        int32_t _lastVoltage = 0;
+        uint32_t _lastSampleMicros = 0;
+        uint32_t _restStartMillis = 0;
+        uint32_t _lastCorrectionMillis = 0;
+        bool _resting = false;
+        bool _initialized = false;
+
+        /**
+         * @brief Charge (mA·s) at open circuit cell voltage, interpolated from OCV table
+         *
+         * @param cellVoltage cell voltage (mV)
+         */
+        int64_t _chargeAtVoltage(int32_t cellVoltage);
+
+        /**
+         * @return state of charge in 0.1 %
+         */
+        int32_t _socPermille();
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include <cmath>
+
+#include "TrackSimplifier.h"
+
+// Metres per 1e-7 degree of latitude (and of longitude at the equator)
+#define METERS_PER_UNIT 0.011132f
+
+TrackSimplifier::TrackSimplifier(float tolerance) : _toleranceSquared(tolerance * tolerance) { }
+
+TrackSimplifier::Result TrackSimplifier::add(int32_t latitude, int32_t longitude) {
+    _pointsIn++;
+
+    if (_count == 0) {
+        // longitude scale is fixed per anchor: error over a window of a few hundred metres is negligible
+        _metersPerLongitude = METERS_PER_UNIT * cosf(latitude * 1e-7f * (float)M_PI / 180.0f);
+        _latitudes[0] = latitude;
+        _longitudes[0] = longitude;
+        _count = 1;
+        _pointsOut++;
+        return EmitCurrent;
+    }
+
+    if (_count < TRACK_SIMPLIFIER_WINDOW && (_count == 1 || _withinTolerance(latitude, longitude))) {
+        _latitudes[_count] = latitude;
+        _longitudes[_count] = longitude;
+        _count++;
+        return Hold;
+    }
+
+    // floater becomes anchor and new point the floater
+    _latitudes[0] = _latitudes[_count - 1];
+    _longitudes[0] = _longitudes[_count - 1];
+    _latitudes[1] = latitude;
+    _longitudes[1] = longitude;
+    _count = 2;
+    _pointsOut++;
+    return EmitFloater;
+}
+
+void TrackSimplifier::reset() {
+    _count = 0;
+}
+
+uint32_t TrackSimplifier::getPointsIn() {
+    return _pointsIn;
+}
+
+uint32_t TrackSimplifier::getPointsOut() {
+    return _pointsOut;
+}
+
+bool TrackSimplifier::_withinTolerance(int32_t latitude, int32_t longitude) {
+    // local flat projection (m) relative to anchor
+    float x = (longitude - _longitudes[0]) * _metersPerLongitude;
+    float y = (latitude - _latitudes[0]) * METERS_PER_UNIT;
+    float lengthSquared = x * x + y * y;
+
+    for (uint8_t i = 1; i < _count; i++) {
+        float px = (_longitudes[i] - _longitudes[0]) * _metersPerLongitude;
+        float py = (_latitudes[i] - _latitudes[0]) * METERS_PER_UNIT;
+
+        // squared distance from segment anchor -> new point: projection clamped to the segment, so points
+        // beyond either end (hairpins, out-and-back) are measured to the nearest end point
+        float t = lengthSquared < 1e-6f ? 0.0f : constrain((px * x + py * y) / lengthSquared, 0.0f, 1.0f);
+        float dx = px - t * x;
+        float dy = py - t * y;
+        float distanceSquared = dx * dx + dy * dy;
+
+        if (distanceSquared > _toleranceSquared) {
+            return false;
+        }
+    }
+    return true;
+}
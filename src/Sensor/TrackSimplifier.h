@@ -0,0 +1,71 @@
+#ifndef _TRACK_SIMPLIFIER_H_
+#define _TRACK_SIMPLIFIER_H_
+
+#include "Particle.h"
+
+// Maximum number of points a single emitted segment can replace (bounds memory and latency: 5 s at 10 Hz)
+#define TRACK_SIMPLIFIER_WINDOW 50
+
+/**
+ * @brief Streaming line simplification (opening window) of gps fixes with a bounded error
+ *
+ * The last emitted point is the anchor and the newest point the floater. A new point becomes the floater
+ * if every point since the anchor is within tolerance (m) of the segment anchor -> new point; otherwise the
+ * floater is emitted and becomes the anchor. Every dropped point is therefore within tolerance of the
+ * emitted track.
+ */
+class TrackSimplifier {
+    public:
+        enum Result {
+            EmitCurrent,    // first point: emit it immediately
+            Hold,           // point replaces floater, nothing to emit
+            EmitFloater     // emit previous floater, point becomes the new floater
+        };
+
+        /**
+         * Constructor
+         *
+         * @param tolerance maximum distance (m) between a dropped point and the emitted track
+         */
+        TrackSimplifier(float tolerance);
+
+        /**
+         * @brief Adds a point to the window
+         *
+         * @param latitude degrees * 1e-7
+         * @param longitude degrees * 1e-7
+         * @return what should be emitted for this point
+         */
+        Result add(int32_t latitude, int32_t longitude);
+
+        /**
+         * @brief Discards window: next point is emitted as a new anchor
+         */
+        void reset();
+
+        /**
+         * @brief Number of points added since startup
+         */
+        uint32_t getPointsIn();
+
+        /**
+         * @brief Number of points emitted since startup (excluding current floater)
+         */
+        uint32_t getPointsOut();
+
+    private:
+        float _toleranceSquared;
+        int32_t _latitudes[TRACK_SIMPLIFIER_WINDOW];
+        int32_t _longitudes[TRACK_SIMPLIFIER_WINDOW];
+        uint8_t _count = 0;     // anchor is index 0, floater is index _count - 1
+        float _metersPerLongitude = 0.0f;
+        uint32_t _pointsIn = 0;
+        uint32_t _pointsOut = 0;
+
+        /**
+         * @return true if every point between anchor and the new point is within tolerance of segment anchor -> new point
+         */
+        bool _withinTolerance(int32_t latitude, int32_t longitude);
+};
+
+#endif
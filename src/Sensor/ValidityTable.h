@@ -0,0 +1,37 @@
+#ifndef _VALIDITY_TABLE_H_
+#define _VALIDITY_TABLE_H_
+
+#include <stdint.h>
+
+/**
+ * @brief Last update time of a fixed set of values, indexed by a small enum (0 to N - 1)
+ *
+ * A value is valid once it has been set and until staleInterval has elapsed. Times are millis() values:
+ * unsigned subtraction keeps the check correct when millis() wraps around. Constant memory, no allocation.
+ */
+template <uint8_t N>
+class ValidityTable {
+    static_assert(N <= 32, "ValidityTable supports at most 32 values");
+
+    public:
+        /**
+         * @return true if value id has been set within staleInterval (ms) before now
+         */
+        bool isValid(uint8_t id, uint32_t now, uint32_t staleInterval) const {
+            return (_seen & (1UL << id)) && (uint32_t)(now - _times[id]) < staleInterval;
+        }
+
+        /**
+         * @brief Records that value id was updated at now
+         */
+        void set(uint8_t id, uint32_t now) {
+            _times[id] = now;
+            _seen |= (1UL << id);
+        }
+
+    private:
+        uint32_t _times[N] = { 0 };
+        uint32_t _seen = 0;
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef _CAN_BUS_H_
+#define _CAN_BUS_H_
+
+#include "Particle.h"
+#include "can.h"
+
+using namespace can;
+
+/**
+ * @brief Abstract CAN controller used by CanInterface
+ * 
+ * @note Implementations exist for the MCP2515 (vehicle hardware), an in-process queue (CanBusVirtual)
+ * and Linux SocketCAN devices (CanBusSocket), so CAN listeners can be driven by recorded traffic off-vehicle
+ */
+class CanBus {
+    public:
+        virtual ~CanBus() { }
+
+        /**
+         * @brief Initialize the controller
+         **/
+        virtual void begin() = 0;
+
+        /**
+         * @brief Reads the next pending message from the controller, if any
+         * 
+         * @param message filled with the received message
+         * @param rxMicros filled with micros() at which the message was received by the bus
+         * @return true if a message was read
+         **/
+        virtual bool readMessage(CanMessage& message, uint32_t& rxMicros) = 0;
+
+        /**
+         * @brief Writes a message to the bus
+         * 
+         * @return true if the message was accepted by the controller
+         **/
+        virtual bool sendMessage(const CanMessage& message) = 0;
+};
+
+#endif
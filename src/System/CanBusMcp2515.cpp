@@ -0,0 +1,34 @@
+#include "CanBusMcp2515.h"
+
+CanBusMcp2515::CanBusMcp2515(SPIClass *spi, uint8_t csPin, uint8_t intPin) {
+    pinMode(intPin, INPUT);
+    _intPin = intPin;
+    _CAN = new mcp2515_can(csPin);
+    _CAN->setSPI(spi);
+}
+
+CanBusMcp2515::~CanBusMcp2515() {
+    delete _CAN;
+}
+
+void CanBusMcp2515::begin() {
+    _CAN->begin(CAN_500KBPS, MCP_8MHz);
+}
+
+bool CanBusMcp2515::readMessage(CanMessage& message, uint32_t& rxMicros) {
+    if (digitalRead(_intPin) || _CAN->checkReceive() != CAN_MSGAVAIL) {
+        return false;
+    }
+
+    message = CAN_MESSAGE_NULL;
+    _CAN->readMsgBuf(&message.dataLength, message.data);
+    message.id = _CAN->getCanId();
+    message.extended = _CAN->isExtendedFrame();
+    message.remote = _CAN->isRemoteRequest();
+    rxMicros = micros();
+    return true;
+}
+
+bool CanBusMcp2515::sendMessage(const CanMessage& message) {
+    return _CAN->sendMsgBuf(message.id, message.extended, message.remote, message.dataLength, message.data) == CAN_OK;
+}
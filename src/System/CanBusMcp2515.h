@@ -0,0 +1,39 @@
+#ifndef _CAN_BUS_MCP2515_H_
+#define _CAN_BUS_MCP2515_H_
+
+#include "CanBus.h"
+#include "mcp2515_can.h"
+
+/**
+ * @brief CanBus implementation for the MCP2515 CAN controller over SPI
+ */
+class CanBusMcp2515 : public CanBus {
+    public:
+        /**
+         * Constructor 
+         * @param *spi bus to use for this CAN module
+         * @param csPin chip select pin to use for this CAN module
+         * @param intPin interrupt pin to use for this CAN module
+         **/
+        CanBusMcp2515(SPIClass *spi, uint8_t csPin, uint8_t intPin);
+
+        ~CanBusMcp2515();
+
+        /**
+         * Begin the CAN module by setting baud rate and chip freq
+         **/
+        void begin() override;
+
+        /**
+         * Checks interrupt pin and then checks to make sure a message has been fully received
+         **/
+        bool readMessage(CanMessage& message, uint32_t& rxMicros) override;
+
+        bool sendMessage(const CanMessage& message) override;
+
+    private:
+        uint8_t _intPin;
+        mcp2515_can* _CAN;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "CanBusSocket.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+CanBusSocket::CanBusSocket(const char* interfaceName) : _interfaceName(interfaceName) { }
+
+CanBusSocket::~CanBusSocket() {
+    if (_socket >= 0) {
+        close(_socket);
+    }
+}
+
+void CanBusSocket::begin() {
+    _socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (_socket < 0) {
+        return;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, _interfaceName, IFNAMSIZ - 1);
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+
+    if (ioctl(_socket, SIOCGIFINDEX, &ifr) < 0) {
+        close(_socket);
+        _socket = -1;
+        return;
+    }
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(_socket);
+        _socket = -1;
+        return;
+    }
+
+    fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+}
+
+bool CanBusSocket::readMessage(CanMessage& message, uint32_t& rxMicros) {
+    struct can_frame frame;
+    if (_socket < 0 || read(_socket, &frame, sizeof(frame)) != sizeof(frame)) {
+        return false;
+    }
+
+    message = CAN_MESSAGE_NULL;
+    message.extended = frame.can_id & CAN_EFF_FLAG;
+    message.remote = frame.can_id & CAN_RTR_FLAG;
+    message.id = frame.can_id & (message.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+    message.dataLength = frame.can_dlc > sizeof(CanData) ? sizeof(CanData) : frame.can_dlc;
+    memcpy(message.data, frame.data, message.dataLength);
+    rxMicros = micros();
+    return true;
+}
+
+bool CanBusSocket::sendMessage(const CanMessage& message) {
+    if (_socket < 0) {
+        return false;
+    }
+
+    struct can_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = message.extended ? ((message.id & CAN_EFF_MASK) | CAN_EFF_FLAG) : (message.id & CAN_SFF_MASK);
+    if (message.remote) {
+        frame.can_id |= CAN_RTR_FLAG;
+    }
+    frame.can_dlc = message.dataLength;
+    memcpy(frame.data, message.data, message.dataLength);
+    return write(_socket, &frame, sizeof(frame)) == sizeof(frame);
+}
+
+bool CanBusSocket::isOpen() {
+    return _socket >= 0;
+}
+
+#endif
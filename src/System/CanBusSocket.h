@@ -0,0 +1,45 @@
+#ifndef _CAN_BUS_SOCKET_H_
+#define _CAN_BUS_SOCKET_H_
+
+// SocketCAN is only available when building for a Linux host
+#if defined(__linux__)
+
+#include "CanBus.h"
+
+/**
+ * @brief CanBus implementation for Linux SocketCAN devices (ie. can0 or a vcan test interface)
+ * 
+ * @note reads are non-blocking, so CanInterface::handle drains the socket the same way it drains the MCP2515
+ */
+class CanBusSocket : public CanBus {
+    public:
+        /**
+         * Constructor
+         * @param interfaceName name of the SocketCAN network interface, ie. "vcan0"
+         **/
+        CanBusSocket(const char* interfaceName);
+
+        ~CanBusSocket();
+
+        /**
+         * Opens and binds a raw CAN socket to the interface
+         **/
+        void begin() override;
+
+        bool readMessage(CanMessage& message, uint32_t& rxMicros) override;
+
+        bool sendMessage(const CanMessage& message) override;
+
+        /**
+         * @return true if the socket was opened and bound successfully
+         **/
+        bool isOpen();
+
+    private:
+        const char* _interfaceName;
+        int _socket = -1;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+#include "CanBusVirtual.h"
+
+CanBusVirtual::CanBusVirtual() { }
+
+CanBusVirtual::~CanBusVirtual() { }
+
+void CanBusVirtual::begin() { }
+
+bool CanBusVirtual::readMessage(CanMessage& message, uint32_t& rxMicros) {
+    if (_rxCount == 0) {
+        return false;
+    }
+
+    message = _rxQueue[_rxHead];
+    rxMicros = micros();
+    _rxHead = (_rxHead + 1) % CAN_VIRTUAL_QUEUE_SIZE;
+    _rxCount--;
+    return true;
+}
+
+bool CanBusVirtual::sendMessage(const CanMessage& message) {
+    uint16_t tail = (_txHead + _txCount) % CAN_VIRTUAL_QUEUE_SIZE;
+    _txQueue[tail] = message;
+
+    // keep the newest messages if nobody is reading sent messages
+    if (_txCount == CAN_VIRTUAL_QUEUE_SIZE) {
+        _txHead = (_txHead + 1) % CAN_VIRTUAL_QUEUE_SIZE;
+    } else {
+        _txCount++;
+    }
+    return true;
+}
+
+bool CanBusVirtual::injectMessage(const CanMessage& message) {
+    if (_rxCount == CAN_VIRTUAL_QUEUE_SIZE) {
+        _dropped++;
+        return false;
+    }
+
+    uint16_t tail = (_rxHead + _rxCount) % CAN_VIRTUAL_QUEUE_SIZE;
+    _rxQueue[tail] = message;
+    _rxCount++;
+    return true;
+}
+
+bool CanBusVirtual::injectCandumpLine(const char* line) {
+    // skip optional timestamp and interface name: frame is the last whitespace-separated token
+    const char* frame = line;
+    for (const char* c = line; *c; c++) {
+        if ((*c == ' ' || *c == '\t') && *(c + 1) > ' ') {
+            frame = c + 1;
+        }
+    }
+
+    CanMessage message = CAN_MESSAGE_NULL;
+    uint32_t id = 0;
+    uint8_t idLength = 0;
+    const char* c = frame;
+    for (; *c && *c != '#'; c++, idLength++) {
+        int8_t value = _hexValue(*c);
+        if (value < 0) {
+            return false;
+        }
+        id = (id << 4) | value;
+    }
+
+    if (*c != '#') {
+        return false;
+    }
+
+    // candump writes standard ids with 3 digits and extended ids with 8
+    message.extended = idLength > 3;
+    message.id = id & (message.extended ? CAN_EXTENDED_ID_MASK : CAN_STANDARD_ID_MASK);
+
+    if (*(c + 1) == 'R') {
+        message.remote = true;
+        return injectMessage(message);
+    }
+
+    for (c++; _hexValue(*c) >= 0 && _hexValue(*(c + 1)) >= 0; c += 2) {
+        if (message.dataLength == sizeof(CanData)) {
+            return false;
+        }
+        message.data[message.dataLength++] = (_hexValue(*c) << 4) | _hexValue(*(c + 1));
+    }
+
+    return injectMessage(message);
+}
+
+bool CanBusVirtual::readSentMessage(CanMessage& message) {
+    if (_txCount == 0) {
+        return false;
+    }
+
+    message = _txQueue[_txHead];
+    _txHead = (_txHead + 1) % CAN_VIRTUAL_QUEUE_SIZE;
+    _txCount--;
+    return true;
+}
+
+uint16_t CanBusVirtual::getPendingCount() {
+    return _rxCount;
+}
+
+uint32_t CanBusVirtual::getDroppedCount() {
+    return _dropped;
+}
+
+int8_t CanBusVirtual::_hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
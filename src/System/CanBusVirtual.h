@@ -0,0 +1,78 @@
+#ifndef _CAN_BUS_VIRTUAL_H_
+#define _CAN_BUS_VIRTUAL_H_
+
+#include "CanBus.h"
+
+// Number of frames which can be pending in each direction of a virtual bus
+#define CAN_VIRTUAL_QUEUE_SIZE 256
+
+/**
+ * @brief In-process CanBus backed by fixed-size frame queues
+ * 
+ * Frames injected with injectMessage (or parsed from candump log lines with injectCandumpLine) are
+ * returned by readMessage, stamped when read (like a hardware bus) so reported latency excludes time spent
+ * waiting in the queue; frames written with sendMessage are kept for inspection with readSentMessage.
+ * Used to replay recorded or synthetic traffic through CanInterface as fast as it can be decoded.
+ */
+class CanBusVirtual : public CanBus {
+    public:
+        CanBusVirtual();
+
+        ~CanBusVirtual();
+
+        void begin() override;
+
+        bool readMessage(CanMessage& message, uint32_t& rxMicros) override;
+
+        bool sendMessage(const CanMessage& message) override;
+
+        /**
+         * @brief Queues a message to be received by CanInterface
+         * 
+         * @return false if the receive queue is full (message is dropped and counted)
+         **/
+        bool injectMessage(const CanMessage& message);
+
+        /**
+         * @brief Parses and queues a frame in candump log format, ie. "(1650000000.000000) can0 6B1#01F400320000"
+         * 8-digit ids are read as extended ids and "123#R" as a remote frame
+         * 
+         * @return false if the line could not be parsed or the receive queue is full
+         **/
+        bool injectCandumpLine(const char* line);
+
+        /**
+         * @brief Pops the oldest message written to this bus with sendMessage
+         * 
+         * @return true if a message was available
+         **/
+        bool readSentMessage(CanMessage& message);
+
+        /**
+         * @brief Number of messages waiting to be read by CanInterface
+         **/
+        uint16_t getPendingCount();
+
+        /**
+         * @brief Number of injected messages dropped because the receive queue was full
+         **/
+        uint32_t getDroppedCount();
+
+    private:
+        CanMessage _rxQueue[CAN_VIRTUAL_QUEUE_SIZE];
+        uint16_t _rxHead = 0;
+        uint16_t _rxCount = 0;
+
+        CanMessage _txQueue[CAN_VIRTUAL_QUEUE_SIZE];
+        uint16_t _txHead = 0;
+        uint16_t _txCount = 0;
+
+        uint32_t _dropped = 0;
+
+        /**
+         * @brief Converts a single hex character to its value, or -1 if invalid
+         **/
+        static int8_t _hexValue(char c);
+};
+
+#endif
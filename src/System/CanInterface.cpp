@@ -1,56 +1,138 @@
 #include "CanInterface.h"
-#define CAN_FRAME 0
+#include "CanBusMcp2515.h"
 
 // #define DEBUG_CAN
 
-CanInterface::CanInterface(SPIClass *spi, uint8_t csPin, uint8_t intPin) {
-    pinMode(intPin, INPUT);
-    _intPin = intPin;
-    _CAN = new mcp2515_can(csPin);
-    _CAN->setSPI(spi);
+// Set in delegate keys of extended ids, which are at most 29 bits
+#define DELEGATE_KEY_EXTENDED 0x80000000
+
+CanInterface::CanInterface(SPIClass *spi, uint8_t csPin, uint8_t intPin) : CanInterface(new CanBusMcp2515(spi, csPin, intPin)) { }
+
+CanInterface::CanInterface(CanBus *bus) {
+    addBus(bus);
+    resetStats();
 }
 
 CanInterface::~CanInterface() {
     for (auto const& pair : _delegates) {
-        delete pair.second;
+        delete pair.second.delegate;
+    }
+    for (uint8_t i = 0; i < _numBuses; i++) {
+        delete _buses[i];
+    }
+}
+
+int CanInterface::addBus(CanBus *bus) {
+    if (_numBuses == CAN_MAX_BUSES) {
+        return -1;
     }
+    _stats[_numBuses] = { 0, 0, 0, 0, 0, 0 };
+    _buses[_numBuses] = bus;
+    return _numBuses++;
 }
 
 void CanInterface::begin() {
-    _CAN->begin(CAN_500KBPS,MCP_8MHz);
+    for (uint8_t i = 0; i < _numBuses; i++) {
+        _buses[i]->begin();
+    }
 }
 
 void CanInterface::handle() {
-    if(!digitalRead(_intPin)){
-        while(_CAN->checkReceive() == CAN_MSGAVAIL){
-            CanMessage message = CAN_MESSAGE_NULL;
-            _CAN->readMsgBuf(&message.dataLength, message.data);
-            message.id = _CAN->getCanId();
-
-            #ifdef DEBUG_CAN 
-                DEBUG_SERIAL_LN("-----------------------------");
-                DEBUG_SERIAL_F("CAN MESSAGE RECEIVED - ID: 0x%X\n", message.id);
-
-                for (int i = 0; i < message.dataLength; i++) { // print the data
-                    DEBUG_SERIAL_F("0x%X\t", message.data[i]);
-                }
-                DEBUG_SERIAL_LN();
-            #endif
-
-            // check if we're listening for id, continue if we're not
-            if(_delegates.find(message.id) == _delegates.end()){
-                continue;
-            }
+    CanMessage message;
+    uint32_t rxMicros;
+    bool received;
 
-            _delegates[message.id]->execute((CommandArgs)&message);
+    do {
+        received = false;
+        for (uint8_t i = 0; i < _numBuses; i++) {
+            if (_buses[i]->readMessage(message, rxMicros)) {
+                message.bus = i;
+                _dispatch(message, rxMicros);
+                received = true;
+            }
         }
+    } while (received);
+}
+
+void CanInterface::addMessageListen(uint32_t id, Command* canListenerDelegate, bool extended) {
+    _delegates[_delegateKey(id, extended)] = { canListenerDelegate, 0, true };
+}
+
+void CanInterface::setListenEnabled(uint32_t id, bool enabled, bool extended) {
+    auto it = _delegates.find(_delegateKey(id, extended));
+    if (it != _delegates.end()) {
+        it->second.enabled = enabled;
     }
 }
 
-void CanInterface::addMessageListen(uint16_t id, Command* canListenerDelegate) {
-    _delegates[id] = canListenerDelegate;
+uint32_t CanInterface::getFrameCount(uint32_t id, bool extended) {
+    auto it = _delegates.find(_delegateKey(id, extended));
+    return it != _delegates.end() ? it->second.frameCount : 0;
 }
 
 void CanInterface::sendMessage(CanMessage message) {
-    _CAN->sendMsgBuf(message.id, CAN_FRAME, message.dataLength, message.data );   
+    if (message.bus >= _numBuses) {
+        return;
+    }
+
+    if (_buses[message.bus]->sendMessage(message)) {
+        _stats[message.bus].framesSent++;
+    } else {
+        _stats[message.bus].sendErrors++;
+    }
+}
+
+const CanInterface::Stats& CanInterface::getStats(uint8_t bus) {
+    return _stats[bus < _numBuses ? bus : 0];
+}
+
+uint8_t CanInterface::getNumBuses() {
+    return _numBuses;
+}
+
+void CanInterface::resetStats() {
+    for (uint8_t i = 0; i < _numBuses; i++) {
+        _stats[i] = { 0, 0, 0, 0, 0, 0 };
+    }
+}
+
+uint32_t CanInterface::_delegateKey(uint32_t id, bool extended) {
+    return extended ? (id | DELEGATE_KEY_EXTENDED) : id;
+}
+
+void CanInterface::_dispatch(CanMessage& message, uint32_t rxMicros) {
+    Stats& stats = _stats[message.bus];
+    stats.framesReceived++;
+
+    #ifdef DEBUG_CAN 
+        DEBUG_SERIAL_LN("-----------------------------");
+        DEBUG_SERIAL_F("CAN MESSAGE RECEIVED - BUS: %d - ID: 0x%X%s\n", message.bus, message.id, message.extended ? " (EXT)" : "");
+
+        for (int i = 0; i < message.dataLength; i++) { // print the data
+            DEBUG_SERIAL_F("0x%X\t", message.data[i]);
+        }
+        DEBUG_SERIAL_LN();
+    #endif
+
+    // check if we're listening for id, return if we're not
+    auto it = _delegates.find(_delegateKey(message.id, message.extended));
+    if (it == _delegates.end()) {
+        return;
+    }
+
+    // disabled ids are only counted
+    Listen& listen = it->second;
+    listen.frameCount++;
+    if (!listen.enabled) {
+        return;
+    }
+
+    listen.delegate->execute((CommandArgs)&message);
+
+    uint32_t latency = micros() - rxMicros;
+    stats.framesDispatched++;
+    stats.totalLatencyMicros += latency;
+    if (latency > stats.maxLatencyMicros) {
+        stats.maxLatencyMicros = latency;
+    }
 }
@@ -5,14 +5,30 @@
 
 #include "can.h"
 #include "Sensor.h"
-#include "mcp2515_can.h"
+#include "CanBus.h"
 #include "can_common.h"
 #include "Command.h"
 
+// Maximum number of CAN controllers one CanInterface can dispatch from
+#define CAN_MAX_BUSES 2
+
 using namespace can;
 
 class CanInterface : public Handleable {
     public:
+        /**
+         * @brief Per-bus receive and dispatch statistics, used to measure decoding throughput and latency
+         **/
+        struct Stats {
+            uint32_t framesReceived;
+            uint32_t framesDispatched;
+            uint32_t framesSent;
+            uint32_t sendErrors;
+            // time from a frame being received by the bus until its listener has finished updating (ie. getters see new data)
+            uint32_t maxLatencyMicros;
+            uint64_t totalLatencyMicros;
+        };
+
         /**
          * Constructor 
          * @param *spi bus to use for this CAN module
@@ -21,40 +37,104 @@ class CanInterface : public Handleable {
          **/
         CanInterface(SPIClass *spi, uint8_t csPin, uint8_t intPin);
 
+        /**
+         * Constructor
+         * @param *bus CAN controller to use as bus 0 (ie. CanBusVirtual for replaying recorded traffic); CanInterface takes ownership
+         **/
+        CanInterface(CanBus *bus);
+
         // look into virtual desctructors in c++
         ~CanInterface();
 
         /**
-         * Begin the CAN sensor by setting baud rate and chip freq
+         * @brief Adds another CAN controller (ie. a second MCP2515 on SPI) behind this interface; CanInterface takes ownership
+         * 
+         * @return index of the new bus, used for CanMessage::bus and getStats, or -1 if CAN_MAX_BUSES controllers are already added
+         **/
+        int addBus(CanBus *bus);
+
+        /**
+         * Begin all CAN bus controllers
          **/
         void begin();
 
         /**
-         * Checks interrupt pin and then checks to make sure a message has been fully received
-         * Saves any messages that match the CAN IDs specificed in IDS array
+         * Reads all messages pending on each CAN bus controller, alternating between controllers so that
+         * a busy bus cannot starve the others
+         * Dispatches any messages that match the CAN IDs added with addMessageListen
          **/
         void handle();
 
         /**
-         * @brief Adds message id for can interface to listen to
+         * @brief Adds message id for can interface to listen to on any bus
          * 
          * @param id to listen for on CAN bus
          * @param delegate delegate command which allows can listeners to specify additional parsing behavior
+         * @param extended true if id is a 29-bit extended identifier
          **/
-        void addMessageListen(uint16_t id, Command* canListenerDelegate);
+        void addMessageListen(uint32_t id, Command* canListenerDelegate, bool extended = false);
+
+        /**
+         * @brief Enables or disables dispatch of a listened id: frames of a disabled id are still counted
+         * (see getFrameCount) but are not passed to its delegate
+         * 
+         * @param id listened id (added with addMessageListen)
+         * @param enabled true to dispatch frames with id
+         * @param extended true if id is a 29-bit extended identifier
+         **/
+        void setListenEnabled(uint32_t id, bool enabled, bool extended = false);
+
+        /**
+         * @brief Number of frames received with a listened id since startup (whether or not dispatch is enabled)
+         * 
+         * @return frame count, 0 if id is not listened to
+         **/
+        uint32_t getFrameCount(uint32_t id, bool extended = false);
          
         /**
          * @brief Wrapper for sending CAN messages
          * 
-         * @param message has the id, data length and data of the message that needs to be sent
+         * @param message has the id, data length and data of the message that needs to be sent, and the bus to send it on
          **/
         void sendMessage(CanMessage message);
 
+        /**
+         * @brief Get receive and dispatch statistics for bus since startup (or last resetStats)
+         **/
+        const Stats& getStats(uint8_t bus = 0);
+
+        /**
+         * @brief Get number of CAN controllers behind this interface
+         **/
+        uint8_t getNumBuses();
+
+        /**
+         * @brief Reset receive and dispatch statistics of all buses
+         **/
+        void resetStats();
+
     private:
-        std::map<uint16_t, Command*> _delegates;
-        uint8_t _intPin;
-        mcp2515_can* _CAN;
+        struct Listen {
+            Command* delegate;
+            uint32_t frameCount;
+            bool enabled;
+        };
+
+        std::map<uint32_t, Listen> _delegates;
+        CanBus* _buses[CAN_MAX_BUSES];
+        Stats _stats[CAN_MAX_BUSES];
+        uint8_t _numBuses = 0;
+
+        /**
+         * @brief Key used in _delegates: standard and extended ids are separate id spaces
+         **/
+        static uint32_t _delegateKey(uint32_t id, bool extended);
+
+        /**
+         * @brief Dispatches message to its listener (if any) and updates stats for bus it was received on
+         **/
+        void _dispatch(CanMessage& message, uint32_t rxMicros);
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,90 @@
+#ifndef _CAN_SIGNAL_H_
+#define _CAN_SIGNAL_H_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace can {
+
+	/**
+	 * @brief Declarative description of a signal packed into the 8 data bytes of a CAN message
+	 * 
+	 * Signals are declared constexpr (see CanSignals.h), so the compiler folds each decoder down to the loads,
+	 * shifts and masks for that one signal, with no branching on the description at runtime.
+	 * 
+	 * @note bit numbering depends on byte order:
+	 *  - LittleEndian: startBit is the least significant bit of the signal, counting from bit 0 of data[0]
+	 *  - BigEndian: startBit is the most significant bit of the signal, counting from the MSB of data[0]
+	 *  (so a byte-aligned signal starting at data[n] has startBit 8 * n in both cases)
+	 */
+	struct CanSignal {
+		enum ByteOrder { LittleEndian, BigEndian };
+		enum ValueType { Unsigned, Signed, Float32 };
+
+		uint8_t startBit;
+		uint8_t length;
+		ByteOrder byteOrder;
+		ValueType valueType;
+		float scale;
+		float offset;
+
+		/**
+		 * @brief Raw unsigned bits of this signal (length <= 32)
+		 */
+		constexpr uint32_t raw(const uint8_t* data) const {
+			return (uint32_t)((_load(data) >> _shift()) & _mask());
+		}
+
+		/**
+		 * @brief Raw bits of this signal, sign extended from length bits
+		 */
+		constexpr int32_t rawSigned(const uint8_t* data) const {
+			return (int32_t)(raw(data) << (32 - length)) >> (32 - length);
+		}
+
+		/**
+		 * @brief Physical value of this signal: raw value * scale + offset
+		 */
+		inline float decode(const uint8_t* data) const {
+			return _value(data) * scale + offset;
+		}
+
+	private:
+		// Only the bytes the signal spans are read, so a byte-aligned signal is one or two loads
+		constexpr uint8_t _firstByte() const {
+			return startBit / 8;
+		}
+
+		constexpr uint8_t _lastByte() const {
+			return (startBit + length - 1) / 8;
+		}
+
+		constexpr uint64_t _load(const uint8_t* data) const {
+			uint64_t word = 0;
+			for (uint8_t i = _firstByte(); i <= _lastByte(); i++) {
+				word |= (uint64_t)data[i] << (byteOrder == LittleEndian ? 8 * (i - _firstByte()) : 8 * (_lastByte() - i));
+			}
+			return word;
+		}
+
+		constexpr uint8_t _shift() const {
+			return byteOrder == LittleEndian ? startBit % 8 : 8 * (_lastByte() + 1) - startBit - length;
+		}
+
+		constexpr uint64_t _mask() const {
+			return (1ull << length) - 1;
+		}
+
+		inline float _value(const uint8_t* data) const {
+			if (valueType == Float32) {
+				float value;
+				uint32_t bits = raw(data);
+				memcpy((void*)&value, (void*)&bits, 4);
+				return value;
+			}
+			return valueType == Signed ? (float)rawSigned(data) : (float)raw(data);
+		}
+	};
+}
+
+#endif
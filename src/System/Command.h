@@ -1,8 +1,6 @@
 #ifndef _COMMAND_H
 #define _COMMAND_H
 
-#include "DataQueue.h"
-
 typedef void* CommandArgs;
 
 /**
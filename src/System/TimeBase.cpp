@@ -0,0 +1,94 @@
+#include "TimeBase.h"
+
+#define MILLISECONDS_IN_SECOND      1000
+#define NANOSECONDS_IN_MILLISECOND  1000000
+
+// Fixes further than this (ms) from the mapping restart it (first fix, gps time jump)
+#define STEP_THRESHOLD_MS       500
+// A fix behind the mapping moves it 1 / 2^SLEW_SHIFT of the way (read latency only ever makes fixes look late)
+#define SLEW_SHIFT              4
+// Drift is estimated from mapping changes over this interval (ms)
+#define DRIFT_INTERVAL_MS       60000
+// Drift estimate moves 1 / 2^DRIFT_SHIFT of the way to each new measurement
+#define DRIFT_SHIFT             2
+// Crystal drift beyond this (ppm) is treated as a bad measurement
+#define MAX_DRIFT_PPM           500.0f
+// A fix this close (ms) to the top of a second is matched with a timepulse received within PULSE_MAX_AGE_MS
+#define PULSE_MATCH_MS          5
+#define PULSE_MAX_AGE_MS        500
+
+TimeBase* TimeBase::_instance;
+
+TimeBase& TimeBase::instance() {
+    if (!_instance) {
+        _instance = new TimeBase();
+    }
+    return *_instance;
+}
+
+void TimeBase::discipline(uint32_t unixEpoch, int32_t nanosecond, uint32_t receivedMillis) {
+    uint64_t unixMillis = (uint64_t)unixEpoch * MILLISECONDS_IN_SECOND + nanosecond / NANOSECONDS_IN_MILLISECOND;
+    uint32_t localMillis = receivedMillis;
+
+    if (_pulsePending && abs(nanosecond / NANOSECONDS_IN_MILLISECOND) <= PULSE_MATCH_MS) {
+        uint32_t pulseMillis = _pulseMillis;
+        _pulsePending = false;
+        if (receivedMillis - pulseMillis <= PULSE_MAX_AGE_MS) {
+            localMillis = pulseMillis;
+        }
+    }
+
+    bool valid;
+    int64_t error = (int64_t)(unixMillis - toUnixMillis(localMillis, valid));
+    if (!_synced || error > STEP_THRESHOLD_MS || error < -STEP_THRESHOLD_MS) {
+        _step(localMillis, unixMillis);
+        return;
+    }
+
+    // negative corrections round down so small offsets don't persist
+    int64_t correction = error > 0 ? error : (error - ((1 << SLEW_SHIFT) - 1)) / (1 << SLEW_SHIFT);
+    _anchorUnixMillis = unixMillis - error + correction;
+    _anchorMillis = localMillis;
+
+    uint32_t baselineElapsed = _anchorMillis - _baselineMillis;
+    if (baselineElapsed >= DRIFT_INTERVAL_MS) {
+        float measured = ((int64_t)(_anchorUnixMillis - _baselineUnixMillis) - (int64_t)baselineElapsed) * 1e6f / baselineElapsed;
+        if (measured > -MAX_DRIFT_PPM && measured < MAX_DRIFT_PPM) {
+            _drift += (measured - _drift) / (1 << DRIFT_SHIFT);
+        }
+        _baselineMillis = _anchorMillis;
+        _baselineUnixMillis = _anchorUnixMillis;
+    }
+}
+
+void TimeBase::timepulse() {
+    _pulseMillis = millis();
+    _pulsePending = true;
+}
+
+uint64_t TimeBase::toUnixMillis(uint32_t localMillis, bool& valid) {
+    valid = _synced;
+    if (!_synced) {
+        return (uint64_t)Time.now() * MILLISECONDS_IN_SECOND;
+    }
+
+    // signed so timestamps taken just before the latest fix map correctly
+    int32_t elapsed = (int32_t)(localMillis - _anchorMillis);
+    return _anchorUnixMillis + elapsed + (int64_t)(elapsed * _drift / 1e6f);
+}
+
+uint64_t TimeBase::nowMillis(bool& valid) {
+    return toUnixMillis(millis(), valid);
+}
+
+float TimeBase::getDrift() {
+    return _drift;
+}
+
+void TimeBase::_step(uint32_t localMillis, uint64_t unixMillis) {
+    _anchorMillis = localMillis;
+    _anchorUnixMillis = unixMillis;
+    _baselineMillis = localMillis;
+    _baselineUnixMillis = unixMillis;
+    _synced = true;
+}
@@ -0,0 +1,80 @@
+#ifndef _TIME_BASE_H_
+#define _TIME_BASE_H_
+
+#include "Particle.h"
+
+/**
+ * @brief Singleton which maps millis() to UTC time (ms), disciplined by GPS fixes
+ *
+ * Each fix gives a (local millis, UTC ms) pair. Fixes are read some time after the solution, so a pair can only
+ * make the local clock look early: a fix ahead of the current mapping is taken immediately, one behind it only
+ * slowly pulls the mapping back. Local oscillator drift is estimated over DRIFT_INTERVAL_MS and applied between
+ * fixes, so timestamps stay accurate through gps outages.
+ *
+ * If the GPS TIMEPULSE output is wired (GPS_TIMEPULSE_PIN), timepulse() stamps the top of each second in an
+ * interrupt and the fix at that second uses the pulse time instead of its read time.
+ **/
+class TimeBase {
+    public:
+        /**
+         * @brief Gets the Singleton instance of this class
+         *
+         * @return reference to time base instance
+         */
+        static TimeBase& instance();
+
+        /**
+         * @brief Updates mapping with a gps fix
+         *
+         * @param unixEpoch fix time (s)
+         * @param nanosecond fix time fraction (ns), may be negative
+         * @param receivedMillis millis() when the fix was read
+         */
+        void discipline(uint32_t unixEpoch, int32_t nanosecond, uint32_t receivedMillis);
+
+        /**
+         * @brief Records a TIMEPULSE edge (top of a UTC second), safe to call from an interrupt
+         */
+        void timepulse();
+
+        /**
+         * @brief Converts a millis() timestamp to UTC time
+         *
+         * @param localMillis value of millis()
+         * @param valid false if time base hasn't been disciplined: whole seconds from Time.now() are returned
+         * @return UTC time (ms since epoch)
+         */
+        uint64_t toUnixMillis(uint32_t localMillis, bool& valid);
+
+        /**
+         * @return current UTC time (ms since epoch), see toUnixMillis
+         */
+        uint64_t nowMillis(bool& valid);
+
+        /**
+         * @return estimated local oscillator drift (ppm, positive if millis() runs slow)
+         */
+        float getDrift();
+
+    private:
+        static TimeBase* _instance;
+
+        bool _synced = false;
+        uint32_t _anchorMillis = 0;
+        uint64_t _anchorUnixMillis = 0;
+        float _drift = 0.0f;
+
+        // drift estimation baseline
+        uint32_t _baselineMillis = 0;
+        uint64_t _baselineUnixMillis = 0;
+
+        volatile uint32_t _pulseMillis = 0;
+        volatile bool _pulsePending = false;
+
+        /**
+         * @brief Restarts mapping (and drift baseline) at a fix
+         */
+        void _step(uint32_t localMillis, uint64_t unixMillis);
+};
+
+#endif
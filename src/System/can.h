@@ -1,19 +1,30 @@
 #ifndef CAN_NAMESPACE_H_
 #define CAN_NAMESPACE_H_
 
+#include <stdint.h>
+
 namespace can {
 
+	// Mask for 11-bit standard and 29-bit extended identifiers
+	const uint32_t CAN_STANDARD_ID_MASK = 0x7FF;
+	const uint32_t CAN_EXTENDED_ID_MASK = 0x1FFFFFFF;
+
 	// This struct contains all the components of a CAN message. dataLength must be <= 8, 
 	// and the first [dataLength] positions of data[] must contain valid data
+	// extended is set for 29-bit identifiers and remote for remote transmission requests (no data)
+	// bus is the index of the CanBus (in CanInterface) the message was received on or will be sent on
 	typedef uint8_t CanData[8];
 	struct CanMessage {
-		uint16_t id;
+		uint32_t id;
 		uint8_t dataLength;
 		CanData data;
+		bool extended;
+		bool remote;
+		uint8_t bus;
 	};
 
 	// generic can message
-	const CanMessage CAN_MESSAGE_NULL = {0x0, 0, {0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0}};
+	const CanMessage CAN_MESSAGE_NULL = {0x0, 0, {0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0}, false, false, 0};
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -5,6 +5,7 @@
 
 // This files defines GPS co-ordinate "boxes" where GPS position will be uploaded
 // If the position is outside of one of these boxes, GPS position not uploaded for security
+// These boxes are the default geofence zones, used when no zone file has been saved (see GeoFence)
 // IMPORTANT: Update this greenlist with any new areas used for testing/competitions
 
 struct positionBox {
@@ -12,13 +13,6 @@ struct positionBox {
     const double southLat;
     const double westLon;
     const double eastLon;
-
-    bool isWithin(double lon, double lat) {
-        if(northLat < southLat || westLon > eastLon) {
-            DEBUG_SERIAL_LN("ERROR: POSITION BOX INVALID!");
-        }
-        return lat <= northLat && lat >= southLat && lon >= westLon && lon <= eastLon;
-    }
 };
 
 const positionBox GREEN_LIST[] = {  {/*N*/49.286, /*S*/49.239, /*W*/-123.281, /*E*/-123.222},   // UBC
@@ -0,0 +1,22 @@
+#ifndef _LAP_GATES_H_
+#define _LAP_GATES_H_
+
+// This file defines the timing gates of the current track: lines between two points which are checked against
+// every gps fix. The first gate is start/finish, the others split the lap into sectors and must be listed
+// in driving order (sector n ends at gate n, the last sector ends at start/finish)
+// IMPORTANT: Update these gates for each competition track
+
+struct timingGate {
+    const double lat1;
+    const double lon1;
+    const double lat2;
+    const double lon2;
+};
+
+const timingGate LAP_GATES[] = {    {/*1*/39.79345, -86.23925, /*2*/39.79345, -86.23855},     // Start/finish
+                                    {/*1*/39.80080, -86.23540, /*2*/39.80015, -86.23490},     // Sector 1
+                                    {/*1*/39.78620, -86.23270, /*2*/39.78655, -86.23215}};    // Sector 2
+
+#define NUM_LAP_GATES (sizeof(LAP_GATES) / sizeof(LAP_GATES[0]))
+
+#endif
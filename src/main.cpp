@@ -209,6 +209,14 @@ int remoteRestartTinyBms(String command) {
 
 }
 
+// Change GPS geofence zones Remotely
+int remoteGeofence(String command) {
+
+    DEBUG_SERIAL_LN("#### REMOTE - Geofence command: " + command);
+    return CurrentVehicle::setGeofence(command);
+
+}
+
 #pragma endregion
 
 /**
@@ -230,6 +238,7 @@ void setup() {
     Particle.function("enableLogging", remoteEnableLogging);
     Particle.function("disableLogging", remoteDisableLogging);
     Particle.function("restartTinyBms", remoteRestartTinyBms);
+    Particle.function("geofence", remoteGeofence);
 
     Time.zone(TIME_ZONE);
 
@@ -24,6 +24,8 @@
 #define LED_FLASH_INT           500
 // Time zone in UTC offset (must manually adjust for DST)
 #define TIME_ZONE               -7
+// GPS TIMEPULSE output pin used to timestamp gps fixes, leave undefined if not wired
+// #define GPS_TIMEPULSE_PIN       D2
 
 /**
  *  MACROS
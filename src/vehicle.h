@@ -42,6 +42,11 @@ namespace CurrentVehicle {
     **/
     void toggleGpsOverride();
 
+    /**
+     * @brief Run a gps geofence zone command (see GeoFence::command)
+    **/
+    int setGeofence(String command);
+
     /**
      * @brief Send Restart message to TinyBMS
     **/
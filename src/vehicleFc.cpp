@@ -1,5 +1,6 @@
 #include "vehicle.h"
 #include "SensorFc.h"
+#include "LapTimer.h"
 #include <vector>
 
 #ifdef FC
@@ -10,6 +11,7 @@ SensorThermo thermo1(&SPI, A5);
 SensorThermo thermo2(&SPI, A4);
 SensorSigStrength sigStrength;
 SensorVoltage inVoltage;
+LapTimer lapTimer(LAP_GATES, NUM_LAP_GATES);
 SensorFc fc(&Serial1);
 
 LoggingCommand<SensorSigStrength, int> signalStrength(&sigStrength, "sigstr", &SensorSigStrength::getStrength, 10);
@@ -19,22 +21,45 @@ LoggingCommand<SensorThermo, int> thermoInt(&thermo1, "tmpint", &SensorThermo::g
 
 LoggingCommand<SensorGps, String> gpsLong(&gps, "lon", &SensorGps::getLongitude, 1);
 LoggingCommand<SensorGps, String> gpsLat(&gps, "lat", &SensorGps::getLatitude, 1);
+LoggingCommand<SensorGps, String> gpsTrack(&gps, "trk", &SensorGps::getTrack, 1);
 LoggingCommand<SensorGps, int> gpsHeading(&gps, "hea", &SensorGps::getHeading, 1);
 LoggingCommand<SensorGps, String> gpsAltitude(&gps, "alt", &SensorGps::getAltitude, 1);
 LoggingCommand<SensorGps, String> gpsHorSpeed(&gps, "hvel", &SensorGps::getHorizontalSpeed, 1);
-LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 1);
+LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 5);
 LoggingCommand<SensorGps, String> gpsHorAccuracy(&gps, "haccu", &SensorGps::getHorizontalAccuracy, 10);
 LoggingCommand<SensorGps, String> gpsVerAccuracy(&gps, "vaccu", &SensorGps::getVerticalAccuracy, 10);
+LoggingCommand<SensorGps, String> gpsTtff(&gps, "ttff", &SensorGps::getTimeToFirstFix, 60);
+LoggingCommand<LapTimer, String> lapEvent(&lapTimer, "lap", &LapTimer::getLap, 1);
 
 LoggingCommand<SensorThermo, int> thermoMotor(&thermo1, "tmpmot", &SensorThermo::getProbeTemp, 5);
 LoggingCommand<SensorThermo, int> thermoFuelCell(&thermo2, "tmpfcs", &SensorThermo::getProbeTemp, 5);
 
+LoggingCommand<SensorFc, String> fcVoltage(&fc, "fcv", &SensorFc::getStackVoltage, 1);
+LoggingCommand<SensorFc, String> fcCurrent(&fc, "fci", &SensorFc::getCurrent, 1);
+LoggingCommand<SensorFc, String> fcStackTemp(&fc, "fctmp", &SensorFc::getStackTemp, 5);
+LoggingCommand<SensorFc, String> fcAmbientTemp(&fc, "fcamb", &SensorFc::getAmbientTemp, 5);
+LoggingCommand<SensorFc, int> fcPurge(&fc, "fcprg", &SensorFc::getPurge, 1);
+LoggingCommand<SensorFc, String> fcRawFrame(&fc, "fcraw", &SensorFc::getRawFrame, 5);
+LoggingCommand<SensorFc, int> fcBadFrames(&fc, "fcbad", &SensorFc::getBadFrames, 30);
+
 String publishName = "BQIngestion";
 
+/**
+ * @brief callback fn passed to gps which receives every valid fix, used for lap timing
+ * 
+ * @param pvt navigation solution
+ */
+void fixCallbackGps(const SensorGps::Pvt& pvt) {
+    lapTimer.addFix(pvt);
+}
+
 // CurrentVehicle namespace definitions
 LoggingDispatcher* CurrentVehicle::buildLoggingDispatcher() {
+    // added here because because this function is called on startup
+    gps.setFixCallback(fixCallbackGps);
+
     LoggingDispatcherBuilder builder(&dataQ, publishName, IntervalCommand::getCommands());
     return builder.build();
 }
@@ -54,10 +79,19 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("Vertical Acceleration: " + gps.getHorizontalAcceleration() + "m/s^2 - ");
     DEBUG_SERIAL("Horizontal Accuracy: " + gps.getHorizontalAccuracy() + "m - ");
     DEBUG_SERIAL("Vertical Accuracy: " + gps.getVerticalAccuracy() + "m - ");
-    DEBUG_SERIAL_LN("Satellites in View: " + String(gps.getSatellitesInView()));
+    DEBUG_SERIAL("Satellites in View: " + String(gps.getSatellitesInView()) + " - ");
+    DEBUG_SERIAL("GPS I2C Time: " + String(gps.getI2cTime()) + "us/poll - ");
+    DEBUG_SERIAL_LN("GPS Handle Time: " + String(gps.getHandleTime()) + "us");
     // Thermo
     DEBUG_SERIAL("Motor Temp: " + String(thermo1.getProbeTemp()) + "°C - ");
     DEBUG_SERIAL_LN("Fuel Cell Temp: " + String(thermo2.getProbeTemp()) + "°C");
+    // Fuel Cell Controller
+    DEBUG_SERIAL("FC Stack Voltage: " + fc.getStackVoltage() + "v - ");
+    DEBUG_SERIAL("FC Current: " + fc.getCurrent() + "A - ");
+    DEBUG_SERIAL("FC Stack Temp: " + fc.getStackTemp() + "°C - ");
+    DEBUG_SERIAL("FC Ambient Temp: " + fc.getAmbientTemp() + "°C - ");
+    DEBUG_SERIAL("FC Purge: " + String(fc.getPurge()) + " - ");
+    DEBUG_SERIAL_LN("FC Bad Frames: " + String(fc.getBadFrames()));
 
     DEBUG_SERIAL_LN();
 
@@ -75,6 +109,10 @@ void CurrentVehicle::toggleGpsOverride() {
     gps.toggleOverride();
 }
 
+int CurrentVehicle::setGeofence(String command) {
+    return gps.geofenceCommand(command);
+}
+
 void CurrentVehicle::restartTinyBms() {
 
 }
@@ -3,6 +3,13 @@
 #ifdef PROTO
 
 #include "SensorEcu.h"
+#include "LapTimer.h"
+#include "FuelIntegrator.h"
+
+// Static flow of each injector (cc/min)
+#define FUEL_INJECTOR_FLOW 190.0
+// Injector opening time (ms)
+#define FUEL_INJECTOR_DEAD_TIME 0.5
 
 // sensor definitions
 SensorGps gps(new SFE_UBLOX_GNSS());
@@ -11,6 +18,8 @@ SensorThermo thermo1(&SPI, A5);
 SensorEcu ecu(&Serial1);
 SensorSigStrength sigStrength;
 SensorVoltage inVoltage;
+LapTimer lapTimer(LAP_GATES, NUM_LAP_GATES);
+FuelIntegrator fuel(&gps, FUEL_INJECTOR_FLOW, FUEL_INJECTOR_DEAD_TIME);
 
 // command definitions
 LoggingCommand<SensorSigStrength, int> signalStrength(&sigStrength, "sigstr", &SensorSigStrength::getStrength, 10);
@@ -20,30 +29,79 @@ LoggingCommand<SensorThermo, int> thermoInt(&thermo1, "tmpint", &SensorThermo::g
 
 LoggingCommand<SensorGps, String> gpsLong(&gps, "lon", &SensorGps::getLongitude, 1);
 LoggingCommand<SensorGps, String> gpsLat(&gps, "lat", &SensorGps::getLatitude, 1);
+LoggingCommand<SensorGps, String> gpsTrack(&gps, "trk", &SensorGps::getTrack, 1);
 LoggingCommand<SensorGps, int> gpsHeading(&gps, "hea", &SensorGps::getHeading, 1);
 LoggingCommand<SensorGps, String> gpsAltitude(&gps, "alt", &SensorGps::getAltitude, 1);
 LoggingCommand<SensorGps, String> gpsHorSpeed(&gps, "hvel", &SensorGps::getHorizontalSpeed, 1);
-LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 1);
+LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 5);
 LoggingCommand<SensorGps, String> gpsHorAccuracy(&gps, "haccu", &SensorGps::getHorizontalAccuracy, 10);
 LoggingCommand<SensorGps, String> gpsVerAccuracy(&gps, "vaccu", &SensorGps::getVerticalAccuracy, 10);
+LoggingCommand<SensorGps, String> gpsTtff(&gps, "ttff", &SensorGps::getTimeToFirstFix, 60);
+LoggingCommand<LapTimer, String> lapEvent(&lapTimer, "lap", &LapTimer::getLap, 1);
 
 LoggingCommand<SensorThermo, int> thermoEng(&thermo1, "tmpeng", &SensorThermo::getProbeTemp, 5);
 
-LoggingCommand<SensorEcu, int> ecuRpm(&ecu, "rpm", &SensorEcu::getRPM, 1);
-LoggingCommand<SensorEcu, String> ecuMap(&ecu, "map", &SensorEcu::getMap, 1);
-LoggingCommand<SensorEcu, int> ecuTps(&ecu, "tps", &SensorEcu::getTPS, 1);
-LoggingCommand<SensorEcu, int> ecuEct(&ecu, "ect", &SensorEcu::getECT, 5);
-LoggingCommand<SensorEcu, int> ecuIat(&ecu, "iat", &SensorEcu::getIAT, 5);
-LoggingCommand<SensorEcu, String> ecuO2s(&ecu, "o2s", &SensorEcu::getO2S, 1);
-LoggingCommand<SensorEcu, int> ecuSpark(&ecu, "spar", &SensorEcu::getSpark, 1);
-LoggingCommand<SensorEcu, String> ecuFuel(&ecu, "pw1", &SensorEcu::getFuelPW1, 1);
+LoggingCommand<FuelIntegrator, String> fuelFlow(&fuel, "flow", &FuelIntegrator::getFlow, 1);
+LoggingCommand<FuelIntegrator, String> fuelTotal(&fuel, "fuel", &FuelIntegrator::getFuel, 10);
+LoggingCommand<FuelIntegrator, String> fuelEconomy(&fuel, "kml", &FuelIntegrator::getEconomy, 10);
+LoggingCommand<FuelIntegrator, String> fuelLap(&fuel, "lapml", &FuelIntegrator::getLapFuel, 10);
+LoggingCommand<FuelIntegrator, String> fuelLapEconomy(&fuel, "lapkml", &FuelIntegrator::getLapEconomy, 10);
+
+LoggingCommand<SensorEcu, String> ecuStats(&ecu, "ecus", &SensorEcu::getStats, 5);
+LoggingCommand<SensorEcu, int> ecuGoodFrames(&ecu, "ecuok", &SensorEcu::getGoodFrames, 30);
+LoggingCommand<SensorEcu, int> ecuBadFrames(&ecu, "ecubad", &SensorEcu::getBadFrames, 30);
 
 String publishName = "BQIngestion";
 
+/**
+ * @brief callback fn passed to gps which receives every valid fix, used for lap timing
+ * 
+ * @param pvt navigation solution
+ */
+void fixCallbackGps(const SensorGps::Pvt& pvt) {
+    lapTimer.addFix(pvt);
+}
+
+/**
+ * @brief callback fn passed to lap timer at each start/finish crossing, closes the fuel lap
+ * 
+ * @return fuel used during the lap (mL)
+ */
+float lapCallback() {
+    float lapFuel = fuel.getCurrentLapFuel();
+    fuel.startLap();
+    return lapFuel;
+}
+
+/**
+ * @brief callback fn passed to ecu which receives every valid frame, integrated into fuel totals
+ * 
+ * @param rpm engine speed
+ * @param fuelPW1 injector 1 pulse width
+ * @param fuelPW2 injector 2 pulse width
+ */
+void fuelCallbackEcu(float rpm, float fuelPW1, float fuelPW2) {
+    fuel.addSample(rpm, fuelPW1, fuelPW2);
+}
+
 // CurrrentVehicle namespace definitions
 LoggingDispatcher* CurrentVehicle::buildLoggingDispatcher() {
+    // added here because because this function is called on startup
+    gps.setFixCallback(fixCallbackGps);
+    lapTimer.setLapCallback(lapCallback);
+    ecu.setFuelCallback(fuelCallbackEcu);
+    // one logging command per ECU field
+    for (uint8_t i = 0; i < ECU_NUM_FIELDS; i++) {
+        const EcuField& field = ECU_FIELDS[i];
+        if (field.type == EcuField::Int) {
+            new IndexedLoggingCommand<SensorEcu, int>(&ecu, field.key, &SensorEcu::getFieldInt, i, field.interval);
+        } else {
+            new IndexedLoggingCommand<SensorEcu, String>(&ecu, field.key, &SensorEcu::getFieldString, i, field.interval);
+        }
+    }
+
     LoggingDispatcherBuilder builder(&dataQ, publishName, IntervalCommand::getCommands());
     return builder.build();
 }
@@ -63,7 +121,9 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("Vertical Acceleration: " + gps.getHorizontalAcceleration() + "m/s^2 - ");
     DEBUG_SERIAL("Horizontal Accuracy: " + gps.getHorizontalAccuracy() + "m - ");
     DEBUG_SERIAL("Vertical Accuracy: " + gps.getVerticalAccuracy() + "m - ");
-    DEBUG_SERIAL_LN("Satellites in View: " + String(gps.getSatellitesInView()));
+    DEBUG_SERIAL("Satellites in View: " + String(gps.getSatellitesInView()) + " - ");
+    DEBUG_SERIAL("GPS I2C Time: " + String(gps.getI2cTime()) + "us/poll - ");
+    DEBUG_SERIAL_LN("GPS Handle Time: " + String(gps.getHandleTime()) + "us");
     // Thermo
     DEBUG_SERIAL_LN("Engine Temp (Thermocouple): " + String(thermo1.getProbeTemp()) + "°C");
     // Engine Computer
@@ -74,7 +134,12 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("ECU Intake Temp: " + String(ecu.getIAT()) + "°C - ");
     DEBUG_SERIAL("ECU O2 Sensor: " + ecu.getO2S() + "v - ");
     DEBUG_SERIAL("ECU Spark Advance: " + String(ecu.getSpark()) + "° - ");
-    DEBUG_SERIAL_LN("ECU Fuel PWM 1: " + ecu.getFuelPW1() + "ms");
+    DEBUG_SERIAL("ECU Fuel PWM 1: " + ecu.getFuelPW1() + "ms - ");
+    DEBUG_SERIAL_LN("ECU Frames Good/Bad: " + String(ecu.getGoodFrames()) + "/" + String(ecu.getBadFrames()));
+    // Fuel
+    DEBUG_SERIAL("Fuel Flow: " + fuel.getFlow() + "mL/min - ");
+    DEBUG_SERIAL("Fuel Used: " + fuel.getFuel() + "mL - ");
+    DEBUG_SERIAL_LN("Fuel Economy: " + fuel.getEconomy() + "km/L");
 
     DEBUG_SERIAL_LN();
 }
@@ -92,6 +157,10 @@ void CurrentVehicle::toggleGpsOverride() {
     gps.toggleOverride();
 }
 
+int CurrentVehicle::setGeofence(String command) {
+    return gps.geofenceCommand(command);
+}
+
 void CurrentVehicle::restartTinyBms() {
     
 }
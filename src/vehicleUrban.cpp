@@ -10,14 +10,27 @@
 #include "CanSensorTinyBms.h"
 #include "CanSensorOrionBms.h"
 #include "BmsManager.h"
+#include "BmsFaultJournal.h"
+#include "EnergyIntegrator.h"
+#include "SocEstimator.h"
+#include "TrackSimplifier.h"
+#include "LapTimer.h"
 
 // starting bms is arbitrary--will change after one or other starts receiving Can messages
 #define DEFAULT_BMS BmsManager::BmsOption::Orion
 
+// Battery pack configuration used by onboard SOC estimate
+#define PACK_CAPACITY_MAH 40000
+#define PACK_SERIES_CELLS 16
+
+// Maximum distance (m) between a dropped gps fix and the logged track
+#define GPS_TRACK_TOLERANCE 1.0
+
 CanInterface canInterface(&SPI1, D5, D6);
 
 // Sensor definitions
 SensorGps gps(new SFE_UBLOX_GNSS());
+TrackSimplifier trackSimplifier(GPS_TRACK_TOLERANCE);
 SensorThermo thermo1(&SPI, A5);
 SensorThermo thermo2(&SPI, A4);
 SensorSigStrength sigStrength;
@@ -26,10 +39,14 @@ CanSensorAccessories canSensorAccessories(canInterface, CAN_ACC_STATUS);
 CanSensorSteering steering(canInterface);
 
 // Bms
-CanSensorTinyBms tinyBms(canInterface, 25);
+CanSensorTinyBms tinyBms(canInterface, 10);
 CanSensorOrionBms orionBms(canInterface);
 CanSensorBms* bms = DEFAULT_BMS == BmsManager::BmsOption::Orion ? (CanSensorBms*)(&orionBms) : (CanSensorBms*)(&tinyBms);
 BmsManager bmsManager(&bms, &orionBms, &tinyBms, DEFAULT_BMS);
+EnergyIntegrator energy(&gps);
+SocEstimator socEstimator(&energy, PACK_CAPACITY_MAH, PACK_SERIES_CELLS);
+BmsFaultJournal faultJournal("BmsFault");
+LapTimer lapTimer(LAP_GATES, NUM_LAP_GATES);
 
 // Command definitions
 LoggingCommand<SensorSigStrength, int> signalStrength(&sigStrength, "sigstr", &SensorSigStrength::getStrength, 10);
@@ -39,14 +56,16 @@ LoggingCommand<SensorThermo, int> thermoInt(&thermo1, "tmpint", &SensorThermo::g
 
 LoggingCommand<SensorGps, String> gpsLong(&gps, "lon", &SensorGps::getLongitude, 1);
 LoggingCommand<SensorGps, String> gpsLat(&gps, "lat", &SensorGps::getLatitude, 1);
+LoggingCommand<SensorGps, String> gpsTrack(&gps, "trk", &SensorGps::getTrack, 1);
 LoggingCommand<SensorGps, int> gpsHeading(&gps, "hea", &SensorGps::getHeading, 1);
 LoggingCommand<SensorGps, String> gpsAltitude(&gps, "alt", &SensorGps::getAltitude, 1);
 LoggingCommand<SensorGps, String> gpsHorSpeed(&gps, "hvel", &SensorGps::getHorizontalSpeed, 1);
-LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 1);
-LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 1);
+LoggingCommand<SensorGps, String> gpsHorAccel(&gps, "hacce", &SensorGps::getHorizontalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsVertAccel(&gps, "vacce", &SensorGps::getVerticalAcceleration, 5);
+LoggingCommand<SensorGps, String> gpsIncline(&gps, "incl", &SensorGps::getIncline, 5);
 LoggingCommand<SensorGps, String> gpsHorAccuracy(&gps, "haccu", &SensorGps::getHorizontalAccuracy, 10);
 LoggingCommand<SensorGps, String> gpsVerAccuracy(&gps, "vaccu", &SensorGps::getVerticalAccuracy, 10);
+LoggingCommand<SensorGps, String> gpsTtff(&gps, "ttff", &SensorGps::getTimeToFirstFix, 60);
 
 LoggingCommand<SensorThermo, int> thermoMotor(&thermo1, "tmpmot", &SensorThermo::getProbeTemp, 5);
 LoggingCommand<SensorThermo, int> thermoMotorController(&thermo2, "tmpmc", &SensorThermo::getProbeTemp, 5);
@@ -56,8 +75,8 @@ LoggingCommand<CanSensorSteering, int> steeringIgnition(&steering, "ign", &CanSe
 LoggingCommand<CanSensorSteering, int> steeringDms(&steering, "dms", &CanSensorSteering::getDms, 1);
 LoggingCommand<CanSensorSteering, int> steeringBrake(&steering, "br", &CanSensorSteering::getBrake, 1);
 
-LoggingCommand<CanSensorBms, String> bmsVoltage(bms, "bmsv", &CanSensorBms::getBatteryVolt, 1);
-LoggingCommand<CanSensorBms, String> bmsCurrent(bms, "bmsa", &CanSensorBms::getBatteryCurrent, 1);
+LoggingCommand<CanSensorBms, String> bmsVoltage(bms, "bmsv", &CanSensorBms::getBatteryVolt, 5);
+LoggingCommand<CanSensorBms, String> bmsCurrent(bms, "bmsa", &CanSensorBms::getBatteryCurrent, 5);
 LoggingCommand<CanSensorBms, String> bmsCellMax(bms, "cmaxv", &CanSensorBms::getMaxVolt, 5);
 LoggingCommand<CanSensorBms, String> bmsCellMin(bms, "cminv", &CanSensorBms::getMinVolt, 5);
 LoggingCommand<CanSensorBms, String> bmsCellAvg(bms, "cavgv", &CanSensorBms::getAvgVolt, 5);
@@ -67,9 +86,28 @@ LoggingCommand<CanSensorBms, int> bmsTempBatt1(bms, "tmpbt1", &CanSensorBms::get
 LoggingCommand<CanSensorBms, int> bmsTempBatt2(bms, "tmpbt2", &CanSensorBms::getMinBatteryTemp, 5);
 LoggingCommand<CanSensorBms, int> bmsCellTempAvg(bms, "tmpavg", &CanSensorBms::getAvgBatteryTemp, 5);
 LoggingCommand<CanSensorBms, int> bmsFault(bms, "bmsf", &CanSensorBms::getFault, 5);
+LoggingCommand<CanSensorBms, String> bmsCells(bms, "cells", &CanSensorBms::getCellVoltages, 30);
 LoggingCommand<CanSensorBms, String> bmsSoc(bms, "soc", &CanSensorBms::getSoc, 10);
+LoggingCommand<CanSensorTinyBms, String> tinyBmsLatency(&tinyBms, "bmslat", &CanSensorTinyBms::getResponseLatency, 10);
+LoggingCommand<CanSensorTinyBms, int> tinyBmsTimeouts(&tinyBms, "bmsto", &CanSensorTinyBms::getResponseTimeouts, 10);
+LoggingCommand<CanSensorOrionBms, int> orionDischargeLimit(&orionBms, "dcl", &CanSensorOrionBms::getDischargeLimit, 5);
+LoggingCommand<CanSensorOrionBms, int> orionChargeLimit(&orionBms, "ccl", &CanSensorOrionBms::getChargeLimit, 5);
+LoggingCommand<CanSensorOrionBms, String> orionBalancing(&orionBms, "bal", &CanSensorOrionBms::getBalancingCells, 10);
+LoggingCommand<CanSensorOrionBms, String> orionCellResistance(&orionBms, "cellr", &CanSensorOrionBms::getCellResistances, 60);
+LoggingCommand<CanSensorOrionBms, String> orionCellOpenVoltage(&orionBms, "cellocv", &CanSensorOrionBms::getCellOpenVoltages, 60);
+LoggingCommand<BmsFaultJournal, int> bmsFaultsUnpublished(&faultJournal, "bmsfq", &BmsFaultJournal::getUnpublishedCount, 30);
 LoggingCommand<BmsManager, int> bmsType(&bmsManager, "bmst", &BmsManager::getCurrentBms, 10);
 
+LoggingCommand<EnergyIntegrator, String> energyCharge(&energy, "ah", &EnergyIntegrator::getCharge, 10);
+LoggingCommand<EnergyIntegrator, String> energyTotal(&energy, "wh", &EnergyIntegrator::getEnergy, 10);
+LoggingCommand<EnergyIntegrator, String> energyDistance(&energy, "odo", &EnergyIntegrator::getDistance, 10);
+LoggingCommand<EnergyIntegrator, String> energyEfficiency(&energy, "whkm", &EnergyIntegrator::getEfficiency, 10);
+LoggingCommand<SocEstimator, String> estimatedSoc(&socEstimator, "esoc", &SocEstimator::getSoc, 30);
+LoggingCommand<SocEstimator, String> estimatedRange(&socEstimator, "range", &SocEstimator::getRange, 30);
+LoggingCommand<EnergyIntegrator, String> energyLap(&energy, "lapwh", &EnergyIntegrator::getLapEnergy, 10);
+LoggingCommand<EnergyIntegrator, String> energyLapEfficiency(&energy, "lapwhkm", &EnergyIntegrator::getLapEfficiency, 10);
+LoggingCommand<LapTimer, String> lapEvent(&lapTimer, "lap", &LapTimer::getLap, 1);
+
 LoggingCommand<CanSensorAccessories, int> urbanHeadlights(&canSensorAccessories, "lhd", &CanSensorAccessories::getStatusHeadlights, 5);
 LoggingCommand<CanSensorAccessories, int> urbanBrakelights(&canSensorAccessories, "lbk", &CanSensorAccessories::getStatusBrakelights, 1);
 LoggingCommand<CanSensorAccessories, int> urbanHorn(&canSensorAccessories, "horn", &CanSensorAccessories::getStatusHorn, 1);
@@ -95,6 +133,48 @@ void speedCallbackGps(float speed) {
     }
 }
 
+/**
+ * @brief callback fn passed to gps which receives every valid fix, used for lap timing
+ * 
+ * @param pvt navigation solution
+ */
+void fixCallbackGps(const SensorGps::Pvt& pvt) {
+    lapTimer.addFix(pvt);
+}
+
+/**
+ * @brief callback fn passed to lap timer at each start/finish crossing, closes the energy lap
+ * 
+ * @return energy drawn during the lap (Wh)
+ */
+float lapCallback() {
+    float lapEnergy = energy.getCurrentLapEnergy();
+    energy.startLap();
+    return lapEnergy;
+}
+
+/**
+ * @brief callback fn passed to both bms which receives every battery current update, integrated into energy totals and soc estimate
+ * 
+ * @param voltage battery voltage
+ * @param current battery current
+ */
+void powerCallbackBms(float voltage, float current) {
+    energy.addSample(voltage, current);
+    socEstimator.addSample(voltage, current);
+}
+
+/**
+ * @brief callback fn passed to both bms which receives every change of fault code, recorded in fault journal
+ * 
+ * @param source bms whose fault changed
+ * @param previousFault fault code before change
+ * @param fault new fault code
+ */
+void faultCallbackBms(CanSensorBms* source, int previousFault, int fault) {
+    faultJournal.record(source, previousFault, fault);
+}
+
 // Set Bms Remotely
 int remoteSetBms(String command){
 	DEBUG_SERIAL("#### REMOTE - Attempting to set BMS to " + command + "BMS module");
@@ -113,6 +193,13 @@ int remoteSetBms(String command){
 LoggingDispatcher* CurrentVehicle::buildLoggingDispatcher() {
     // added here because because this function is called on startup
     gps.setSpeedCallback(speedCallbackGps);
+    gps.setTrackSimplifier(&trackSimplifier);
+    gps.setFixCallback(fixCallbackGps);
+    lapTimer.setLapCallback(lapCallback);
+    tinyBms.setPowerCallback(powerCallbackBms);
+    orionBms.setPowerCallback(powerCallbackBms);
+    tinyBms.setFaultCallback(faultCallbackBms);
+    orionBms.setFaultCallback(faultCallbackBms);
 	
     LoggingDispatcherBuilder builder(&dataQ, publishName, IntervalCommand::getCommands());
     return builder.build();
@@ -134,7 +221,10 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("Vertical Acceleration: " + gps.getIncline() + "° - ");
     DEBUG_SERIAL("Horizontal Accuracy: " + gps.getHorizontalAccuracy() + "m - ");
     DEBUG_SERIAL("Vertical Accuracy: " + gps.getVerticalAccuracy() + "m - ");
-    DEBUG_SERIAL_LN("Satellites in View: " + String(gps.getSatellitesInView()));
+    DEBUG_SERIAL("Satellites in View: " + String(gps.getSatellitesInView()) + " - ");
+    DEBUG_SERIAL("GPS I2C Time: " + String(gps.getI2cTime()) + "us/poll - ");
+    DEBUG_SERIAL("GPS Handle Time: " + String(gps.getHandleTime()) + "us - ");
+    DEBUG_SERIAL_LN("Track Points Kept: " + String(trackSimplifier.getPointsOut()) + "/" + String(trackSimplifier.getPointsIn()));
     // Thermo
     DEBUG_SERIAL("Motor Temp: " + String(thermo1.getProbeTemp()) + "°C - ");
     DEBUG_SERIAL_LN("Motor Controller Temp: " + String(thermo2.getProbeTemp()) + "°C");
@@ -157,6 +247,12 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("Min Battery Temperature: " + String(bms->getMaxBatteryTemp()) + "°C - ");
     DEBUG_SERIAL_LN("Max Battery Temperature: " + String(bms->getMinBatteryTemp()) + "°C");
     DEBUG_SERIAL_LN("Avg Battery Temperature: " + String(bms->getAvgBatteryTemp()) + "°C");
+    // Energy
+    DEBUG_SERIAL("Charge: " + energy.getCharge() + "Ah - ");
+    DEBUG_SERIAL("Energy: " + energy.getEnergy() + "Wh - ");
+    DEBUG_SERIAL("Distance: " + energy.getDistance() + "km - ");
+    DEBUG_SERIAL("Efficiency: " + energy.getEfficiency() + "Wh/km - ");
+    DEBUG_SERIAL_LN("Laps: " + String(lapTimer.getLapNumber()) + " - Last Lap: " + lapTimer.getLastLapTime() + "s");
 
     // CAN Accessories
     DEBUG_SERIAL("Headlights: " + BOOL_TO_STRING(canSensorAccessories.getStatusHeadlights()) + " - ");
@@ -166,6 +262,14 @@ void CurrentVehicle::debugSensorData() {
     DEBUG_SERIAL("Right Signal: " + BOOL_TO_STRING(canSensorAccessories.getStatusRightSignal()) + " - ");
     DEBUG_SERIAL("Left Signal: " + BOOL_TO_STRING(canSensorAccessories.getStatusLeftSignal()) + " - ");
     DEBUG_SERIAL_LN("Wipers: " + BOOL_TO_STRING(canSensorAccessories.getStatusWipers()));
+    // CAN Buses
+    for (uint8_t i = 0; i < canInterface.getNumBuses(); i++) {
+        const CanInterface::Stats& stats = canInterface.getStats(i);
+        DEBUG_SERIAL("CAN Bus " + String(i) + " Frames Received: " + String(stats.framesReceived) + " - ");
+        DEBUG_SERIAL("Dispatched: " + String(stats.framesDispatched) + " - ");
+        DEBUG_SERIAL("Sent: " + String(stats.framesSent) + " - ");
+        DEBUG_SERIAL_LN("Send Errors: " + String(stats.sendErrors));
+    }
 
     DEBUG_SERIAL_LN();
 }
@@ -183,6 +287,10 @@ void CurrentVehicle::toggleGpsOverride() {
     gps.toggleOverride();
 }
 
+int CurrentVehicle::setGeofence(String command) {
+    return gps.geofenceCommand(command);
+}
+
 void CurrentVehicle::restartTinyBms() {
     bms->restart();
 }
@@ -0,0 +1,228 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CanInterface.h"
+#include "CanBusVirtual.h"
+#include "CanBusSocket.h"
+#include "CanSignals.h"
+#include "TestUtil.h"
+
+#define NUM_CYCLES          20000
+
+#define ID_STEERING_READY   0x102
+#define ID_ORION_PACK       0x6B1
+#define ID_ORION_TEMP       0x6B3
+#define ID_TINYBMS_RESPONSE 0x501
+#define ID_UNLISTENED       0x7DF
+#define ID_EXTENDED         0x18FF50E5
+
+/**
+ * @brief Listener delegate decoding a frame with CanSignals, like CanSensorOrionBms and CanSensorTinyBms
+ */
+class Decoder : public Command {
+    public:
+        uint32_t frames = 0;
+        float value = 0.0f;
+
+        Decoder(const can::CanSignal& signal) : _signal(signal) { }
+
+        void execute(CommandArgs args) override {
+            CanMessage* message = (CanMessage*)args;
+            value = _signal.decode(message->data);
+            frames++;
+        }
+
+    private:
+        const can::CanSignal& _signal;
+};
+
+/**
+ * @return one recorded cycle of vehicle traffic per i in candump log format: listened standard and extended ids,
+ * a disabled id, an unlistened id and a remote frame
+ */
+std::vector<std::string> makeCandump() {
+    std::vector<std::string> lines;
+    char line[64];
+    for (uint32_t i = 0; i < NUM_CYCLES; i++) {
+        uint32_t time = i * 10000;
+        // pack voltage ramps 300.0 - 399.9 V in tenths
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#%04X00320000", time % 1000000, ID_ORION_PACK, 3000 + i % 1000);
+        lines.push_back(line);
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#05", time % 1000000, ID_STEERING_READY);
+        lines.push_back(line);
+        // TinyBMS temperature (signed tenths) in bytes 3-4, from -20.0 degC
+        int16_t temp = -200 + i % 400;
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#011B00%02X%02X010000", time % 1000000, ID_TINYBMS_RESPONSE,
+            (uint16_t)temp & 0xFF, (uint16_t)temp >> 8);
+        lines.push_back(line);
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#1819141600000000", time % 1000000, ID_ORION_TEMP);
+        lines.push_back(line);
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#0201", time % 1000000, ID_UNLISTENED);
+        lines.push_back(line);
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %08X#0102030405060708", time % 1000000, ID_EXTENDED);
+        lines.push_back(line);
+        snprintf(line, sizeof(line), "(1650000000.%06u) can0 %03X#R", time % 1000000, ID_UNLISTENED);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+std::vector<std::string> readCandump(const char* path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    for (std::string line; std::getline(file, line); ) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+/**
+ * @brief Replays lines through bus into canInterface, keeping the bus queue full
+ *
+ * @return seconds spent parsing and dispatching
+ */
+double replay(CanInterface& canInterface, CanBusVirtual* bus, const std::vector<std::string>& lines) {
+    auto start = std::chrono::steady_clock::now();
+    size_t next = 0;
+    while (next < lines.size() || bus->getPendingCount() > 0) {
+        while (next < lines.size() && bus->getPendingCount() < CAN_VIRTUAL_QUEUE_SIZE) {
+            bus->injectCandumpLine(lines[next++].c_str());
+        }
+        canInterface.handle();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printStats(const char* name, const CanInterface::Stats& stats, double seconds) {
+    printf("%s: %u frames received, %u dispatched in %.3f s (%.0f frames/s), latency max %u us mean %.3f us\n",
+        name, stats.framesReceived, stats.framesDispatched, seconds, stats.framesReceived / seconds, stats.maxLatencyMicros,
+        stats.framesDispatched > 0 ? (double)stats.totalLatencyMicros / stats.framesDispatched : 0.0);
+}
+
+void testVirtualReplay(const char* path) {
+    std::vector<std::string> lines = path ? readCandump(path) : makeCandump();
+
+    CanBusVirtual* bus = new CanBusVirtual();
+    CanInterface canInterface(bus);
+    Decoder* pack = new Decoder(CanSignals::OrionBms::PACK_VOLTAGE);
+    Decoder* ready = new Decoder(CanSignals::Steering::BRAKE);
+    Decoder* temp = new Decoder(CanSignals::TinyBms::TEMP);
+    Decoder* orionTemp = new Decoder(CanSignals::OrionBms::TEMP_BMS);
+    Decoder* extended = new Decoder(CanSignals::Steering::THROTTLE);
+    canInterface.addMessageListen(ID_ORION_PACK, pack);
+    canInterface.addMessageListen(ID_STEERING_READY, ready);
+    canInterface.addMessageListen(ID_TINYBMS_RESPONSE, temp);
+    canInterface.addMessageListen(ID_ORION_TEMP, orionTemp);
+    canInterface.addMessageListen(ID_EXTENDED, extended, true);
+    canInterface.setListenEnabled(ID_ORION_TEMP, false);
+    canInterface.begin();
+
+    double seconds = replay(canInterface, bus, lines);
+    const CanInterface::Stats& stats = canInterface.getStats();
+    printStats(path ? path : "virtual bus", stats, seconds);
+
+    CHECK_EQUAL(0, bus->getDroppedCount());
+    CHECK(stats.maxLatencyMicros * (uint64_t)stats.framesDispatched >= stats.totalLatencyMicros);
+    CHECK_EQUAL(stats.framesDispatched, pack->frames + ready->frames + temp->frames + orionTemp->frames + extended->frames);
+    if (path) {
+        return;
+    }
+
+    // every line parses, and only enabled listened ids are dispatched
+    CHECK_EQUAL(lines.size(), stats.framesReceived);
+    CHECK_EQUAL(4 * NUM_CYCLES, stats.framesDispatched);
+    CHECK_EQUAL(NUM_CYCLES, pack->frames);
+    CHECK_EQUAL(NUM_CYCLES, ready->frames);
+    CHECK_EQUAL(NUM_CYCLES, temp->frames);
+    CHECK_EQUAL(NUM_CYCLES, extended->frames);
+    CHECK_EQUAL(0, orionTemp->frames);
+    CHECK_EQUAL(NUM_CYCLES, canInterface.getFrameCount(ID_ORION_TEMP));
+    CHECK_EQUAL(0, canInterface.getFrameCount(ID_EXTENDED));
+    CHECK_EQUAL(NUM_CYCLES, canInterface.getFrameCount(ID_EXTENDED, true));
+
+    // values of the last cycle
+    CHECK(fabsf(pack->value - (3000 + (NUM_CYCLES - 1) % 1000) / 10.0f) < 0.01f);
+    CHECK_EQUAL(1, ready->value);
+    CHECK(fabsf(temp->value - (-200 + (NUM_CYCLES - 1) % 400) / 10.0f) < 0.01f);
+    CHECK_EQUAL(1, extended->value);
+
+    // sent frames are kept by the virtual bus
+    CanMessage request = CAN_MESSAGE_NULL;
+    request.id = 0x401;
+    request.dataLength = 2;
+    request.data[0] = 0x1B;
+    canInterface.sendMessage(request);
+    CanMessage sent;
+    CHECK(bus->readSentMessage(sent));
+    CHECK_EQUAL(0x401, sent.id);
+    CHECK_EQUAL(0x1B, sent.data[0]);
+    CHECK_EQUAL(1, stats.framesSent);
+}
+
+void testSocketMissingInterface() {
+    CanBusSocket* socket = new CanBusSocket("vcan-missing");
+    CanInterface canInterface(socket);
+    canInterface.begin();
+    CHECK(!socket->isOpen());
+
+    canInterface.handle();
+    canInterface.sendMessage(CAN_MESSAGE_NULL);
+    CHECK_EQUAL(0, canInterface.getStats().framesReceived);
+    CHECK_EQUAL(1, canInterface.getStats().sendErrors);
+}
+
+/**
+ * @brief Sends the replay out of one socket and dispatches it from another on the same interface (ie. vcan0)
+ */
+void testSocketReplay(const char* interfaceName) {
+    CanBusSocket sender(interfaceName);
+    sender.begin();
+    CanBusSocket* receiver = new CanBusSocket(interfaceName);
+    CanInterface canInterface(receiver);
+    Decoder* pack = new Decoder(CanSignals::OrionBms::PACK_VOLTAGE);
+    canInterface.addMessageListen(ID_ORION_PACK, pack);
+    canInterface.begin();
+    CHECK(sender.isOpen() && receiver->isOpen());
+
+    // frames are written in bursts smaller than the socket receive buffer
+    CanBusVirtual frames;
+    std::vector<std::string> lines = makeCandump();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t next = 0; next < lines.size(); ) {
+        while (next < lines.size() && frames.getPendingCount() < CAN_VIRTUAL_QUEUE_SIZE) {
+            frames.injectCandumpLine(lines[next++].c_str());
+        }
+        CanMessage message;
+        uint32_t rxMicros;
+        while (frames.readMessage(message, rxMicros)) {
+            sender.sendMessage(message);
+        }
+        canInterface.handle();
+    }
+    canInterface.handle();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printStats(interfaceName, canInterface.getStats(), seconds);
+    CHECK(pack->frames > 0);
+}
+
+/**
+ * Usage: CanReplayTest [candump.log]
+ * Replays a candump log (or a synthetic one) through CanBusVirtual; set CAN_REPLAY_INTERFACE (ie. vcan0) to also
+ * replay through a SocketCAN interface
+ */
+int main(int argc, char** argv) {
+    testVirtualReplay(argc > 1 ? argv[1] : NULL);
+    testSocketMissingInterface();
+    const char* interfaceName = getenv("CAN_REPLAY_INTERFACE");
+    if (interfaceName) {
+        testSocketReplay(interfaceName);
+    }
+    return TEST_RESULT();
+}
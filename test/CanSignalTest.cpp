@@ -0,0 +1,198 @@
+#include <chrono>
+#include <cmath>
+
+#include "CanSignals.h"
+#include "TestUtil.h"
+
+#define NUM_FRAMES  100000
+
+using namespace CanSignals;
+
+/**
+ * Decoders replaced by CanSignals.h, copied from CanSensorSteering, CanSensorOrionBms and CanSensorTinyBms
+ * as they were before the signal database (reference for equivalence and timing)
+ */
+namespace Legacy {
+    #define RSP_DATA_BYTE 0x2
+
+    int16_t orionParseInt16(uint8_t* buf) {
+        return (float)( *buf << 8 | *(buf + 1) );
+    }
+
+    float tinyParseFloat(uint8_t* dataPtr) {
+        float output;
+        memcpy((void*)&output, (void*)(dataPtr + RSP_DATA_BYTE), 4);
+        return output;
+    }
+
+    uint16_t tinyParseInt16(uint8_t* dataPtr) {
+        return ((uint16_t)dataPtr[RSP_DATA_BYTE + 1] << 8)
+                | dataPtr[RSP_DATA_BYTE];
+    }
+
+    uint32_t tinyParseInt32(uint8_t* dataPtr) {
+        return ((uint32_t)dataPtr[RSP_DATA_BYTE + 3] << 24)
+                | ((uint32_t)dataPtr[RSP_DATA_BYTE + 2] << 16)
+                | ((uint32_t)dataPtr[RSP_DATA_BYTE + 1] << 8)
+                | dataPtr[RSP_DATA_BYTE];
+    }
+}
+
+/**
+ * @brief Deterministic random frames
+ */
+class Frames {
+    public:
+        Frames() : _state(1) {
+            for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+                for (uint8_t j = 0; j < 8; j++) {
+                    _state = _state * 1664525u + 1013904223u;
+                    _data[i][j] = _state >> 24;
+                }
+            }
+        }
+
+        uint8_t* operator[](uint32_t i) {
+            return _data[i];
+        }
+
+    private:
+        uint32_t _state;
+        uint8_t _data[NUM_FRAMES][8];
+};
+
+static Frames frames;
+
+/**
+ * @return true if values are equal within float rounding of a different scale operation (ie. / 10.0 vs * 0.1f)
+ */
+bool closeTo(float expected, float actual) {
+    if (std::isnan(expected) || std::isnan(actual)) {
+        return std::isnan(expected) && std::isnan(actual);
+    }
+    return fabsf(expected - actual) <= 1e-6f * fmaxf(1.0f, fabsf(expected));
+}
+
+void testSteering() {
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        uint8_t* data = frames[i];
+        mismatches += Steering::THROTTLE.raw(data) != data[0];
+        mismatches += Steering::IGNITION.raw(data) != ((data[0] >> 0x00) & 0x01);
+        mismatches += Steering::DMS.raw(data) != ((data[0] >> 0x01) & 0x01);
+        mismatches += Steering::BRAKE.raw(data) != ((data[0] >> 0x02) & 0x01);
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+void testOrion() {
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        uint8_t* data = frames[i];
+        mismatches += OrionBms::DISCHARGE_ENABLED.raw(data) != (data[0] & 0x1 ? 1u : 0u);
+        mismatches += OrionBms::CHARGE_ENABLED.raw(data) != (data[0] & 0x2 ? 1u : 0u);
+        mismatches += !closeTo((float)Legacy::orionParseInt16(data) / 10.0f, OrionBms::PACK_VOLTAGE.decode(data));
+        mismatches += !closeTo((float)Legacy::orionParseInt16(data + 2) / 10.0f, OrionBms::PACK_CURRENT.decode(data));
+        mismatches += !closeTo((float)data[4] / 2.0f, OrionBms::PACK_SOC.decode(data));
+        mismatches += !closeTo((float)Legacy::orionParseInt16(data) / 1000.0f, OrionBms::CELL_VOLTAGE_MIN.decode(data));
+        mismatches += !closeTo((float)Legacy::orionParseInt16(data + 2) / 1000.0f, OrionBms::CELL_VOLTAGE_MAX.decode(data));
+        mismatches += !closeTo((float)Legacy::orionParseInt16(data + 4) / 1000.0f, OrionBms::CELL_VOLTAGE_AVG.decode(data));
+        mismatches += OrionBms::TEMP_BATTERY_MIN.raw(data) != data[0];
+        mismatches += OrionBms::TEMP_BATTERY_MAX.raw(data) != data[1];
+        mismatches += OrionBms::TEMP_BATTERY_AVG.raw(data) != data[2];
+        mismatches += OrionBms::TEMP_BMS.raw(data) != data[3];
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+void testTinyBms() {
+    uint32_t mismatches = 0;
+    uint32_t positiveTempMismatches = 0;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        uint8_t* data = frames[i];
+        mismatches += TinyBms::STATUS.raw(data) != data[0];
+        mismatches += TinyBms::PARAM_ID.raw(data) != data[1];
+        mismatches += !closeTo(Legacy::tinyParseFloat(data), TinyBms::BATTERY_VOLTAGE.decode(data));
+        mismatches += !closeTo(-Legacy::tinyParseFloat(data), TinyBms::BATTERY_CURRENT.decode(data));
+        mismatches += !closeTo((float)Legacy::tinyParseInt16(data) / 1000.0, TinyBms::CELL_VOLTAGE.decode(data));
+        mismatches += TinyBms::ONLINE_STATUS.raw(data) != Legacy::tinyParseInt16(data);
+        mismatches += !closeTo((float)Legacy::tinyParseInt32(data) / 1000000.0, TinyBms::SOC.decode(data));
+        mismatches += TinyBms::TEMP_ID.raw(data) != data[5];
+        mismatches += TinyBms::EVENT_ID.raw(data) != data[6];
+        mismatches += TinyBms::EVENT_FLAG.raw(data) != data[7];
+
+        // temperatures: same as before when positive, the old decoder read negative values as unsigned
+        uint16_t rawTemp = Legacy::tinyParseInt16(data + 1);
+        if (rawTemp < 0x8000) {
+            positiveTempMismatches += (int)TinyBms::TEMP.decode(data) != rawTemp / 10;
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+    CHECK_EQUAL(0, positiveTempMismatches);
+}
+
+void testTinyBmsNegativeTemp() {
+    // -12.5 degC as signed 16 bit tenths (0xFF83) in bytes 3-4, temp id in byte 5
+    uint8_t data[8] = { 0x01, 0x1B, 0x00, 0x83, 0xFF, 0x01, 0x00, 0x00 };
+    CHECK(closeTo(-12.5f, TinyBms::TEMP.decode(data)));
+    CHECK_EQUAL(-12, (int)TinyBms::TEMP.decode(data));
+    CHECK_EQUAL(1, TinyBms::TEMP_ID.raw(data));
+    // the old decoder reported 6541 degC
+    CHECK_EQUAL(6541, Legacy::tinyParseInt16(data + 1) / 10);
+}
+
+/**
+ * @return ns per frame to decode every field of a message, with the decoded values summed so they aren't optimized out
+ */
+template <class Decoder>
+double time(Decoder decoder) {
+    volatile float sink = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 10; repeat++) {
+        for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+            sink = sink + decoder(frames[i]);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (10.0 * NUM_FRAMES);
+}
+
+void benchmark() {
+    double legacyOrion = time([](uint8_t* data) {
+        return (float)Legacy::orionParseInt16(data) / 10.0f + (float)Legacy::orionParseInt16(data + 2) / 10.0f
+            + (float)data[4] / 2.0f;
+    });
+    double signalOrion = time([](uint8_t* data) {
+        return OrionBms::PACK_VOLTAGE.decode(data) + OrionBms::PACK_CURRENT.decode(data) + OrionBms::PACK_SOC.decode(data);
+    });
+
+    double legacyTiny = time([](uint8_t* data) {
+        return Legacy::tinyParseFloat(data) + (float)Legacy::tinyParseInt16(data) / 1000.0f
+            + (float)Legacy::tinyParseInt32(data) / 1000000.0f + (float)(Legacy::tinyParseInt16(data + 1) / 10);
+    });
+    double signalTiny = time([](uint8_t* data) {
+        return TinyBms::BATTERY_VOLTAGE.decode(data) + TinyBms::CELL_VOLTAGE.decode(data) + TinyBms::SOC.decode(data)
+            + (float)(int)TinyBms::TEMP.decode(data);
+    });
+
+    double legacySteering = time([](uint8_t* data) {
+        return (float)(data[0] + ((data[0] >> 0x00) & 0x01) + ((data[0] >> 0x01) & 0x01) + ((data[0] >> 0x02) & 0x01));
+    });
+    double signalSteering = time([](uint8_t* data) {
+        return (float)(Steering::THROTTLE.raw(data) + Steering::IGNITION.raw(data) + Steering::DMS.raw(data)
+            + Steering::BRAKE.raw(data));
+    });
+
+    printf("decode ns/frame     hand-written  CanSignal\n");
+    printf("  steering ready    %12.2f  %9.2f\n", legacySteering, signalSteering);
+    printf("  orion pack        %12.2f  %9.2f\n", legacyOrion, signalOrion);
+    printf("  tinybms response  %12.2f  %9.2f\n", legacyTiny, signalTiny);
+}
+
+int main() {
+    testSteering();
+    testOrion();
+    testTinyBms();
+    testTinyBmsNegativeTemp();
+    benchmark();
+    return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+#include <chrono>
+
+#include "EcuFields.h"
+#include "TestUtil.h"
+
+#define NUM_FRAMES  100000
+
+/**
+ * Decoder replaced by ECU_FIELDS, copied from SensorEcu before the field table (reference for equivalence and timing)
+ */
+namespace Legacy {
+    float interpretValue(uint8_t high, uint8_t low, float factor, float offset) {
+        return (float)((int)high * 256 + (int)low) * factor + offset;
+    }
+
+    void decode(const uint8_t* buffer, float* values) {
+        values[0] = interpretValue(buffer[6], buffer[7], 0.25, 0.0);
+        values[1] = interpretValue(buffer[8], buffer[9], 0.0039, 0.0);
+        values[2] = interpretValue(buffer[10], buffer[11], 0.0015, 0.0);
+        values[3] = interpretValue(buffer[12], buffer[13], 1, -40.0);
+        values[4] = interpretValue(buffer[14], buffer[15], 1, -40.0);
+        values[5] = interpretValue(buffer[16], buffer[17], 0.0048, 0.0);
+        values[6] = interpretValue(buffer[18], buffer[19], 0.5, 0.0);
+        values[7] = interpretValue(buffer[20], buffer[21], 0.001, 0.0);
+        values[8] = interpretValue(buffer[22], buffer[23], 0.001, 0.0);
+        values[9] = interpretValue(buffer[24], buffer[25], 0.00625, 0.0);
+    }
+}
+
+/**
+ * @brief Deterministic random frame contents (header and checksum aren't decoded)
+ */
+static uint8_t frames[NUM_FRAMES][ECU_PACKET_SIZE];
+
+void makeFrames() {
+    uint32_t state = 1;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        for (uint8_t j = 0; j < ECU_PACKET_SIZE; j++) {
+            state = state * 1664525u + 1013904223u;
+            frames[i][j] = state >> 24;
+        }
+    }
+}
+
+void testMatchesLegacy() {
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+        float expected[ECU_NUM_FIELDS];
+        float actual[ECU_NUM_FIELDS];
+        Legacy::decode(frames[i], expected);
+        decodeEcuFields(frames[i], actual);
+        for (uint8_t j = 0; j < ECU_NUM_FIELDS; j++) {
+            mismatches += expected[j] != actual[j];
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+void testKnownFrame() {
+    uint8_t frame[ECU_PACKET_SIZE] = { };
+    frame[6] = 0x2E;    // 12000 * 0.25 = 3000 rpm
+    frame[7] = 0xE0;
+    frame[12] = 0x00;   // 130 - 40 = 90 degC
+    frame[13] = 0x82;
+    frame[24] = 0x08;   // 2240 * 0.00625 = 14 V
+    frame[25] = 0xC0;
+    float values[ECU_NUM_FIELDS];
+    decodeEcuFields(frame, values);
+    CHECK_EQUAL(3000, values[0]);
+    CHECK_EQUAL(90, values[3]);
+    CHECK_EQUAL(-40, values[4]);
+    CHECK(values[9] > 13.99f && values[9] < 14.01f);
+}
+
+/**
+ * @return ns per frame to decode every field, with the values summed so they aren't optimized out
+ */
+template <class Decoder>
+double time(Decoder decoder) {
+    volatile float sink = 0.0f;
+    float values[ECU_NUM_FIELDS];
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < 10; repeat++) {
+        for (uint32_t i = 0; i < NUM_FRAMES; i++) {
+            decoder(frames[i], values);
+            sink = sink + values[0] + values[ECU_NUM_FIELDS - 1];
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (10.0 * NUM_FRAMES);
+}
+
+int main() {
+    makeFrames();
+    testMatchesLegacy();
+    testKnownFrame();
+    printf("decode ns/frame  _interpretValue %.2f  ECU_FIELDS %.2f\n", time(Legacy::decode), time(decodeEcuFields));
+    return TEST_RESULT();
+}
@@ -0,0 +1,131 @@
+#include <vector>
+
+#include "EcuFrameParser.h"
+#include "TestUtil.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+/**
+ * @return valid frame whose data bytes start at seed (never a header byte)
+ */
+Bytes makeFrame(uint8_t seed) {
+    Bytes frame = { ECU_HEADER_1, ECU_HEADER_2, ECU_HEADER_3, ECU_DATA_FIELD_LENGTH, ECU_SERVICE_ID };
+    for (uint8_t i = 0; frame.size() < ECU_PACKET_SIZE - 1; i++) {
+        frame.push_back((seed + i) & 0x3F);
+    }
+    uint8_t checksum = 0;
+    for (uint8_t byte : frame) {
+        checksum += byte;
+    }
+    frame.push_back(checksum);
+    return frame;
+}
+
+Bytes concat(std::initializer_list<Bytes> parts) {
+    Bytes bytes;
+    for (const Bytes& part : parts) {
+        bytes.insert(bytes.end(), part.begin(), part.end());
+    }
+    return bytes;
+}
+
+/**
+ * @return frames completed while feeding bytes one at a time
+ */
+std::vector<Bytes> feed(EcuFrameParser& parser, const Bytes& bytes) {
+    std::vector<Bytes> frames;
+    for (uint8_t byte : bytes) {
+        if (parser.add(byte)) {
+            frames.push_back(Bytes(parser.getFrame(), parser.getFrame() + ECU_PACKET_SIZE));
+        }
+    }
+    return frames;
+}
+
+void testCleanStream() {
+    EcuFrameParser parser;
+    std::vector<Bytes> frames = feed(parser, concat({ makeFrame(1), makeFrame(2), makeFrame(3) }));
+
+    CHECK_EQUAL(3, frames.size());
+    CHECK(frames.size() == 3 && frames[2] == makeFrame(3));
+    CHECK_EQUAL(3, parser.getGoodFrames());
+    CHECK_EQUAL(0, parser.getBadFrames());
+    CHECK_EQUAL(0, parser.getSkippedBytes());
+}
+
+void testCorruptedFrame() {
+    Bytes corrupted = makeFrame(1);
+    corrupted[10] ^= 0x01;
+
+    EcuFrameParser parser;
+    std::vector<Bytes> frames = feed(parser, concat({ corrupted, makeFrame(2) }));
+
+    // rest of the bad frame is skipped one byte at a time, next frame is intact
+    CHECK_EQUAL(1, frames.size());
+    CHECK(frames.size() == 1 && frames[0] == makeFrame(2));
+    CHECK_EQUAL(1, parser.getGoodFrames());
+    CHECK_EQUAL(1, parser.getBadFrames());
+    CHECK_EQUAL(ECU_PACKET_SIZE - 1, parser.getSkippedBytes());
+}
+
+void testTruncatedFrameHidesHeader() {
+    // a frame cut off after 13 bytes: the next frame's header is inside the 27 bytes checked with it
+    Bytes frame = makeFrame(1);
+    Bytes truncated(frame.begin(), frame.begin() + 13);
+
+    EcuFrameParser parser;
+    std::vector<Bytes> frames = feed(parser, concat({ truncated, makeFrame(2), makeFrame(3) }));
+
+    CHECK_EQUAL(2, frames.size());
+    CHECK(frames.size() == 2 && frames[0] == makeFrame(2) && frames[1] == makeFrame(3));
+    CHECK_EQUAL(2, parser.getGoodFrames());
+    CHECK_EQUAL(1, parser.getBadFrames());
+    CHECK_EQUAL(12, parser.getSkippedBytes());
+}
+
+void testStrayHeaderBytes() {
+    // partial headers between frames are skipped without losing the frame after them
+    Bytes stray = { ECU_HEADER_1, ECU_HEADER_2, ECU_HEADER_1, 0x00, ECU_HEADER_1, ECU_HEADER_2, ECU_HEADER_3, 0x00 };
+
+    EcuFrameParser parser;
+    std::vector<Bytes> frames = feed(parser, concat({ makeFrame(1), stray, makeFrame(2) }));
+
+    CHECK_EQUAL(2, frames.size());
+    CHECK_EQUAL(2, parser.getGoodFrames());
+    CHECK_EQUAL(0, parser.getBadFrames());
+    CHECK_EQUAL(stray.size(), parser.getSkippedBytes());
+}
+
+void testTruncatedAtEnd() {
+    // incomplete frame is held, not reported
+    Bytes frame = makeFrame(1);
+
+    EcuFrameParser parser;
+    std::vector<Bytes> frames = feed(parser, Bytes(frame.begin(), frame.end() - 1));
+
+    CHECK_EQUAL(0, frames.size());
+    CHECK_EQUAL(0, parser.getBadFrames());
+    CHECK(parser.add(frame.back()));
+}
+
+void testReset() {
+    Bytes frame = makeFrame(1);
+
+    EcuFrameParser parser;
+    feed(parser, Bytes(frame.begin(), frame.begin() + 20));
+    parser.reset();
+    std::vector<Bytes> frames = feed(parser, concat({ frame }));
+
+    CHECK_EQUAL(1, frames.size());
+    CHECK_EQUAL(0, parser.getBadFrames());
+}
+
+int main() {
+    testCleanStream();
+    testCorruptedFrame();
+    testTruncatedFrameHidesHeader();
+    testStrayHeaderBytes();
+    testTruncatedAtEnd();
+    testReset();
+    return TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+#include <cmath>
+
+#include "KinematicFilter.h"
+#include "TestUtil.h"
+
+// 10 Hz navigation rate
+#define DT                  0.1f
+#define SAMPLES_PER_SECOND  10
+
+/**
+ * @brief Deterministic gaussian noise (LCG + Box-Muller) so results don't depend on the standard library
+ */
+class Noise {
+    public:
+        Noise(uint32_t seed) : _state(seed) { }
+
+        float next(float sigma) {
+            float u1 = (_uniform() + 1.0f) / 4294967297.0f;
+            float u2 = _uniform() / 4294967296.0f;
+            return sigma * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+        }
+
+    private:
+        uint32_t _state;
+
+        float _uniform() {
+            _state = _state * 1664525u + 1013904223u;
+            return (float)_state;
+        }
+};
+
+struct Result {
+    float filterRms;        // rms error of estimated rate while it is constant
+    float differenceRms;    // rms error of finite differences over the same samples
+    float lag;              // time (s) for the estimated rate to reach 90 % of a step
+};
+
+/**
+ * @brief Fixture: 60 s of 10 Hz measurements with gaussian noise, held constant for 20 s then ramping
+ * at rate (a step of the rate, ie. the car starting to accelerate or climb)
+ *
+ * @param sigma measurement noise, also reported to the filter as accuracy
+ */
+Result run(KinematicFilter& filter, float sigma, float rate) {
+    Noise noise(12345);
+    const int stepSample = 20 * SAMPLES_PER_SECOND;
+    const int numSamples = 60 * SAMPLES_PER_SECOND;
+    // rate is compared once the filter has settled (5 s after start and after step)
+    const int settle = 5 * SAMPLES_PER_SECOND;
+
+    double filterError = 0.0;
+    double differenceError = 0.0;
+    int count = 0;
+    float lag = -1.0f;
+    float previousMeasured = 0.0f;
+
+    for (int i = 0; i < numSamples; i++) {
+        bool ramping = i > stepSample;
+        float value = 10.0f + (ramping ? (i - stepSample) * DT * rate : 0.0f);
+        float truth = ramping ? rate : 0.0f;
+
+        float measured = value + noise.next(sigma);
+        filter.update(measured, sigma, i == 0 ? 0.0f : DT);
+
+        float estimate = filter.getRate();
+        float difference = (measured - previousMeasured) / DT;
+        previousMeasured = measured;
+
+        if ((i > settle && i < stepSample) || i > stepSample + settle) {
+            filterError += (estimate - truth) * (estimate - truth);
+            differenceError += (difference - truth) * (difference - truth);
+            count++;
+        }
+
+        if (lag < 0.0f && ramping && estimate >= 0.9f * rate) {
+            lag = (i - stepSample) * DT;
+        }
+    }
+
+    Result result;
+    result.filterRms = sqrt(filterError / count);
+    result.differenceRms = sqrt(differenceError / count);
+    result.lag = lag;
+    return result;
+}
+
+// Typical receiver accuracy estimates: speed (m/s) and altitude (m)
+#define SPEED_ACCURACY      0.2f
+#define ALTITUDE_ACCURACY   1.5f
+
+void testHorizontalAcceleration() {
+    // speed starts increasing at 1 m/s^2
+    KinematicFilter filter(2, GPS_HORIZONTAL_PROCESS_NOISE);
+    Result result = run(filter, SPEED_ACCURACY, 1.0f);
+    printf("acceleration: rms error %.3f m/s^2 (finite differences %.3f), 90 %% step response %.1f s\n",
+        result.filterRms, result.differenceRms, result.lag);
+
+    CHECK(result.filterRms < result.differenceRms / 4.0f);
+    CHECK(result.lag >= 0.0f && result.lag <= 1.0f);
+}
+
+void testVerticalSpeed() {
+    // altitude starts increasing at 0.5 m/s (a 5 % grade at 10 m/s)
+    KinematicFilter filter(3, GPS_VERTICAL_PROCESS_NOISE);
+    Result result = run(filter, ALTITUDE_ACCURACY, 0.5f);
+    printf("vertical speed: rms error %.3f m/s (finite differences %.3f), 90 %% step response %.1f s\n",
+        result.filterRms, result.differenceRms, result.lag);
+
+    CHECK(result.filterRms < result.differenceRms / 4.0f);
+    CHECK(result.lag >= 0.0f && result.lag <= 3.0f);
+}
+
+void testGapRestarts() {
+    KinematicFilter filter(2, GPS_HORIZONTAL_PROCESS_NOISE);
+    filter.update(5.0f, SPEED_ACCURACY, 0.0f);
+    filter.update(6.0f, SPEED_ACCURACY, DT);
+    CHECK(filter.getRate() > 0.0f);
+
+    // after a gap longer than MAX_DT the filter starts over from the measurement
+    filter.update(20.0f, SPEED_ACCURACY, 5.0f);
+    CHECK(filter.getValue() == 20.0f);
+    CHECK(filter.getRate() == 0.0f);
+}
+
+int main() {
+    testHorizontalAcceleration();
+    testVerticalSpeed();
+    testGapRestarts();
+    return TEST_RESULT();
+}
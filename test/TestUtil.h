@@ -0,0 +1,30 @@
+#ifndef _TEST_UTIL_H_
+#define _TEST_UTIL_H_
+
+#include <cstdio>
+
+static int testFailures = 0;
+
+// Reports a failed condition and keeps running the remaining checks
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do { \
+        long long _expected = (long long)(expected); \
+        long long _actual = (long long)(actual); \
+        if (_expected != _actual) { \
+            printf("%s:%d: CHECK_EQUAL failed: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, _expected); \
+            testFailures++; \
+        } \
+    } while (0)
+
+// Process exit code: 0 if every check passed
+#define TEST_RESULT() (printf("%s: %s\n", __FILE__, testFailures == 0 ? "passed" : "FAILED"), testFailures == 0 ? 0 : 1)
+
+#endif
@@ -0,0 +1,174 @@
+#include <cmath>
+#include <vector>
+
+#include "TrackSimplifier.h"
+#include "TestUtil.h"
+
+// Metres per 1e-7 degree of latitude, as in TrackSimplifier.cpp
+#define METERS_PER_UNIT     0.011132
+#define LAP_LATITUDE        39.7950
+#define LAP_LONGITUDE       -86.2350
+// Logged track tolerance used by URBAN
+#define TOLERANCE           1.0f
+// Allowance for TrackSimplifier's single precision projection (m)
+#define PROJECTION_ERROR    0.02
+
+struct Point {
+    double x;   // east (m)
+    double y;   // north (m)
+};
+
+/**
+ * @brief Appends an arc around center from angle start to end (radians) in steps of about 1 m
+ */
+void addArc(std::vector<Point>& path, Point center, double radius, double start, double end) {
+    int steps = (int)ceil(fabs(end - start) * radius);
+    for (int i = 1; i <= steps; i++) {
+        double angle = start + (end - start) * i / steps;
+        path.push_back({ center.x + radius * cos(angle), center.y + radius * sin(angle) });
+    }
+}
+
+/**
+ * @brief Fixture: a ~1.3 km lap with straights, a 15 m hairpin, a 60 m sweeper and an out-and-back spur
+ * (the car driving back over its own track), sampled at 10 Hz and 12 m/s with ~0.3 m of fix noise
+ */
+std::vector<Point> makeLap() {
+    std::vector<Point> corners = { { 0, 0 }, { 400, 0 } };
+    addArc(corners, { 400, 15 }, 15, -M_PI / 2, M_PI / 2);
+    corners.push_back({ 100, 30 });
+    corners.push_back({ 100, 130 });
+    corners.push_back({ 100, 30 });
+    corners.push_back({ 0, 30 });
+    addArc(corners, { 0, 90 }, 60, -M_PI / 2, -3 * M_PI / 2);
+    addArc(corners, { -60, 45 }, 45, M_PI / 2, 3 * M_PI / 2);
+    corners.push_back({ 0, 0 });
+
+    std::vector<Point> fixes;
+    const double spacing = 1.2;
+    double carry = 0.0;
+    uint32_t noise = 1;
+    for (size_t i = 1; i < corners.size(); i++) {
+        double dx = corners[i].x - corners[i - 1].x;
+        double dy = corners[i].y - corners[i - 1].y;
+        double length = sqrt(dx * dx + dy * dy);
+        for (double d = carry; d < length; d += spacing) {
+            // deterministic noise in [-0.3, 0.3] m
+            noise = noise * 1664525u + 1013904223u;
+            double nx = ((noise >> 8) % 601) / 1000.0 - 0.3;
+            noise = noise * 1664525u + 1013904223u;
+            double ny = ((noise >> 8) % 601) / 1000.0 - 0.3;
+            fixes.push_back({ corners[i - 1].x + dx * d / length + nx, corners[i - 1].y + dy * d / length + ny });
+            carry = d + spacing - length;
+        }
+    }
+    return fixes;
+}
+
+int32_t toLatitude(const Point& point) {
+    return (int32_t)lround(LAP_LATITUDE * 1e7 + point.y / METERS_PER_UNIT);
+}
+
+int32_t toLongitude(const Point& point) {
+    return (int32_t)lround(LAP_LONGITUDE * 1e7 + point.x / (METERS_PER_UNIT * cos(LAP_LATITUDE * M_PI / 180.0)));
+}
+
+/**
+ * @brief Converts a fix back to metres after rounding to the logged 1e-7 degree resolution
+ */
+Point toMeters(const Point& point) {
+    return { (toLongitude(point) - LAP_LONGITUDE * 1e7) * METERS_PER_UNIT * cos(LAP_LATITUDE * M_PI / 180.0),
+             (toLatitude(point) - LAP_LATITUDE * 1e7) * METERS_PER_UNIT };
+}
+
+double segmentDistance(const Point& point, const Point& a, const Point& b) {
+    double x = b.x - a.x;
+    double y = b.y - a.y;
+    double lengthSquared = x * x + y * y;
+    double t = lengthSquared > 0.0 ? ((point.x - a.x) * x + (point.y - a.y) * y) / lengthSquared : 0.0;
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    return hypot(point.x - a.x - t * x, point.y - a.y - t * y);
+}
+
+/**
+ * @return indices of emitted fixes, including the floater still held at the end (flushed by SensorGps)
+ */
+std::vector<size_t> simplify(TrackSimplifier& simplifier, const std::vector<Point>& fixes) {
+    std::vector<size_t> emitted;
+    for (size_t i = 0; i < fixes.size(); i++) {
+        TrackSimplifier::Result result = simplifier.add(toLatitude(fixes[i]), toLongitude(fixes[i]));
+        if (result == TrackSimplifier::EmitCurrent) {
+            emitted.push_back(i);
+        } else if (result == TrackSimplifier::EmitFloater) {
+            // floater is always the previous fix
+            emitted.push_back(i - 1);
+        }
+    }
+    if (emitted.back() != fixes.size() - 1) {
+        emitted.push_back(fixes.size() - 1);
+    }
+    return emitted;
+}
+
+void testLap() {
+    std::vector<Point> fixes = makeLap();
+    TrackSimplifier simplifier(TOLERANCE);
+    std::vector<size_t> emitted = simplify(simplifier, fixes);
+
+    printf("lap: kept %zu of %zu fixes (%.1f %%)\n", emitted.size(), fixes.size(), 100.0 * emitted.size() / fixes.size());
+    CHECK_EQUAL(fixes.size(), simplifier.getPointsIn());
+    // flushed floater isn't counted by the simplifier
+    CHECK(simplifier.getPointsOut() == emitted.size() || simplifier.getPointsOut() + 1 == emitted.size());
+    CHECK(emitted.size() < fixes.size() / 4);
+
+    // every dropped fix is within tolerance of the emitted segment it was replaced by
+    double maxDistance = 0.0;
+    for (size_t e = 1; e < emitted.size(); e++) {
+        Point a = toMeters(fixes[emitted[e - 1]]);
+        Point b = toMeters(fixes[emitted[e]]);
+        for (size_t i = emitted[e - 1] + 1; i < emitted[e]; i++) {
+            maxDistance = fmax(maxDistance, segmentDistance(toMeters(fixes[i]), a, b));
+        }
+    }
+    printf("lap: largest distance of a dropped fix to the track %.3f m (tolerance %.1f m)\n", maxDistance, TOLERANCE);
+    CHECK(maxDistance <= TOLERANCE + PROJECTION_ERROR);
+}
+
+void testOutAndBack() {
+    // driving north then straight back: the turnaround must be kept
+    std::vector<Point> fixes;
+    for (int i = 0; i <= 20; i++) {
+        fixes.push_back({ 0, i * 1.0 });
+    }
+    for (int i = 19; i >= 0; i--) {
+        fixes.push_back({ 0, i * 1.0 });
+    }
+
+    TrackSimplifier simplifier(TOLERANCE);
+    std::vector<size_t> emitted = simplify(simplifier, fixes);
+
+    CHECK_EQUAL(3, emitted.size());
+    CHECK(emitted.size() == 3 && emitted[1] == 20);
+}
+
+void testWindowLimit() {
+    // a long straight is split every TRACK_SIMPLIFIER_WINDOW fixes
+    std::vector<Point> fixes;
+    for (int i = 0; i < 4 * TRACK_SIMPLIFIER_WINDOW; i++) {
+        fixes.push_back({ i * 1.0, 0 });
+    }
+
+    TrackSimplifier simplifier(TOLERANCE);
+    std::vector<size_t> emitted = simplify(simplifier, fixes);
+
+    for (size_t e = 1; e < emitted.size(); e++) {
+        CHECK(emitted[e] - emitted[e - 1] <= TRACK_SIMPLIFIER_WINDOW);
+    }
+}
+
+int main() {
+    testLap();
+    testOutAndBack();
+    testWindowLimit();
+    return TEST_RESULT();
+}
@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <new>
+
+#include "ValidityTable.h"
+#include "TestUtil.h"
+
+#define STALE_INTERVAL  2000
+#define ITERATIONS      1000000
+
+// Heap allocations made through operator new
+static size_t allocations = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    allocatedBytes += size;
+    void* memory = malloc(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+// not inlined, so gcc doesn't pair the free with the map's operator new (-Wmismatched-new-delete)
+__attribute__((noinline)) void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+/**
+ * @brief Validation as CanSensorBms did before ValidityTable: last update time per TinyBMS parameter id in a
+ * std::map, pre-filled by the constructor
+ */
+class ValidationMap {
+    public:
+        ValidationMap() {
+            for (uint16_t id : { 0x14, 0x15, 0x16, 0x17, 0x18, 0x1A, 0x1B, 0x00, 0x01, 0x02, 0x11 }) {
+                _validationMap[id] = 0;
+            }
+        }
+
+        bool isValid(uint16_t id, uint64_t now) {
+            return (now - _validationMap[id]) < STALE_INTERVAL;
+        }
+
+        void set(uint16_t id, uint64_t now) {
+            _validationMap[id] = now;
+        }
+
+    private:
+        std::map<uint16_t, uint64_t> _validationMap;
+};
+
+// TinyBMS parameter ids in the order of the ValidityTable ids used for them
+const uint16_t PARAM_IDS[] = { 0x14, 0x15, 0x16, 0x17, 0x1A, 0x00, 0x01, 0x02, 0x18, 0x11, 0x1B };
+#define NUM_IDS (sizeof(PARAM_IDS) / sizeof(PARAM_IDS[0]))
+
+struct Benchmark {
+    double nanosecondsPerCheck;
+    size_t allocations;
+    size_t bytes;
+    uint32_t validCount;
+};
+
+/**
+ * @brief Workload: a response updates one value, then all getters are validated (as logging does every second,
+ * but back to back), time advancing 1 ms per iteration
+ */
+template <class Table, class Id>
+Benchmark run(const Id* ids) {
+    size_t allocationsBefore = allocations;
+    size_t bytesBefore = allocatedBytes;
+    uint32_t validCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        Table table;
+        for (uint32_t i = 0; i < ITERATIONS; i++) {
+            table.set(ids[i % NUM_IDS], i);
+            uint32_t valid = 0;
+            for (uint8_t j = 0; j < NUM_IDS; j++) {
+                valid += table.isValid(ids[j], i) ? 1 : 0;
+            }
+            // results are only comparable once every value has been set
+            validCount += i >= NUM_IDS ? valid : 0;
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return { elapsed / ((double)ITERATIONS * NUM_IDS), allocations - allocationsBefore, allocatedBytes - bytesBefore, validCount };
+}
+
+/**
+ * @brief Adapts ValidityTable to the benchmark's isValid(id, now) with the default stale interval
+ */
+class Table {
+    public:
+        bool isValid(uint8_t id, uint32_t now) const {
+            return _table.isValid(id, now, STALE_INTERVAL);
+        }
+
+        void set(uint8_t id, uint32_t now) {
+            _table.set(id, now);
+        }
+
+    private:
+        ValidityTable<NUM_IDS> _table;
+};
+
+void testValidity() {
+    ValidityTable<4> table;
+    CHECK(!table.isValid(0, 0, STALE_INTERVAL));
+    CHECK(!table.isValid(0, 1000, STALE_INTERVAL));
+
+    table.set(0, 1000);
+    CHECK(table.isValid(0, 1000, STALE_INTERVAL));
+    CHECK(table.isValid(0, 2999, STALE_INTERVAL));
+    CHECK(!table.isValid(0, 3000, STALE_INTERVAL));
+    CHECK(!table.isValid(1, 1000, STALE_INTERVAL));
+    CHECK(table.isValid(0, 3000, 5000));
+
+    // millis() wraps around
+    table.set(2, UINT32_MAX - 500);
+    CHECK(table.isValid(2, 1000, STALE_INTERVAL));
+    CHECK(!table.isValid(2, 1500, STALE_INTERVAL));
+}
+
+void testBenchmark() {
+    uint8_t tableIds[NUM_IDS];
+    for (uint8_t i = 0; i < NUM_IDS; i++) {
+        tableIds[i] = i;
+    }
+
+    Benchmark map = run<ValidationMap>(PARAM_IDS);
+    Benchmark table = run<Table>(tableIds);
+
+    printf("std::map:      %6.2f ns/check, %zu allocations (%zu bytes)\n", map.nanosecondsPerCheck, map.allocations, map.bytes);
+    printf("ValidityTable: %6.2f ns/check, %zu allocations (%zu bytes)\n", table.nanosecondsPerCheck, table.allocations, table.bytes);
+
+    // same results (before every value has been set, the map version reported values as valid for 2 s after boot)
+    CHECK_EQUAL(map.validCount, table.validCount);
+    CHECK_EQUAL(0, table.allocations);
+    CHECK(map.allocations >= NUM_IDS);
+    CHECK(table.nanosecondsPerCheck < map.nanosecondsPerCheck);
+}
+
+int main() {
+    testValidity();
+    testBenchmark();
+    return TEST_RESULT();
+}
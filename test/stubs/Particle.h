@@ -0,0 +1,41 @@
+#ifndef _TEST_PARTICLE_STUB_H_
+#define _TEST_PARTICLE_STUB_H_
+
+// Minimal stand-in for Particle.h so hardware-independent classes build on the host
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using std::max;
+using std::min;
+
+template <class T>
+T constrain(T value, T low, T high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+inline uint32_t micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline uint32_t millis() {
+    return micros() / 1000;
+}
+
+// Hardware is never touched on the host: pins read low and SPI is only passed through
+#define INPUT 0
+
+inline void pinMode(uint16_t, uint8_t) { }
+
+inline int32_t digitalRead(uint16_t) {
+    return 0;
+}
+
+class SPIClass { };
+
+class String;
+
+#endif
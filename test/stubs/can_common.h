@@ -0,0 +1,6 @@
+#ifndef _TEST_CAN_COMMON_STUB_H_
+#define _TEST_CAN_COMMON_STUB_H_
+
+// Stand-in for the shared CAN id library: host tests use the ids they replay directly
+
+#endif
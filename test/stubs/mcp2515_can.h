@@ -0,0 +1,27 @@
+#ifndef _TEST_MCP2515_CAN_STUB_H_
+#define _TEST_MCP2515_CAN_STUB_H_
+
+// Stand-in for the Seeed MCP2515 library: a controller that never receives and accepts every send
+
+#include "Particle.h"
+
+#define CAN_OK          0
+#define CAN_MSGAVAIL    3
+#define CAN_NOMSG       4
+#define CAN_500KBPS     16
+#define MCP_8MHz        1
+
+class mcp2515_can {
+    public:
+        mcp2515_can(uint8_t) { }
+        void setSPI(SPIClass*) { }
+        uint8_t begin(uint32_t, uint8_t) { return CAN_OK; }
+        uint8_t checkReceive() { return CAN_NOMSG; }
+        uint8_t readMsgBuf(uint8_t* length, uint8_t*) { *length = 0; return CAN_NOMSG; }
+        unsigned long getCanId() { return 0; }
+        uint8_t isExtendedFrame() { return 0; }
+        uint8_t isRemoteRequest() { return 0; }
+        uint8_t sendMsgBuf(unsigned long, uint8_t, uint8_t, uint8_t, const uint8_t*, bool = true) { return CAN_OK; }
+};
+
+#endif